@@ -0,0 +1,43 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ Header file               *
+ * File: AlignedAllocator.h                 *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#pragma once
+#include <cstddef>
+#include <new>
+
+// ======== CLASS ======== //
+// std::vector allocator handing out Align-byte aligned storage (C++17 aligned new)
+template <typename T, std::size_t Align>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Align>&) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Align>&) const noexcept { return false; }
+};
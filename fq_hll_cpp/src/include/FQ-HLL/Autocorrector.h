@@ -7,19 +7,32 @@
 
 // ======== INCLUDE ======== //
 #pragma once
-#include "HyperLogLog.h"
+#include "DictionaryIndex.h"
+#include "EditDistance.h"
+#include "Intersect.h"
+#include "Popcount.h"
+#include "Rcu.h"
+#include "ResultCache.h"
+#include "ThreadPool.h"
+#include <array>
 #include <iostream>
 #include <unordered_map>
 #include <variant>
+#include <string_view>
 #include <unordered_set>
 #include <filesystem>
 #include <fstream>
 #include <cmath>
+#include <cstring>
 #include <chrono>
+#include <functional>
+#include <iomanip>
+#include <sstream>
 
 // ======== DEFINE ======== //
 using StrVec = std::variant<std::string, std::vector<std::string>>;
 static const std::vector<std::string> addon_files = {"texting"};
+using IndexEdit = std::function<std::vector<std::string>(DictionaryIndex&)>; // Replayable, so it only captures by value
 
 // ======== STRUCT ======== //
 typedef struct AutocorrectorCfg {
@@ -29,6 +42,15 @@ typedef struct AutocorrectorCfg {
     double alpha = 0.2;
     double beta = 0.35;
     int b = 10;
+    bool use_postings = true; // Candidates via qgram posting lists, false scans every word's bitarray
+    bool use_pruning = false; // Size/prefix filter words that can never reach the lowest tau in autocorrect
+    std::string row_format = "auto"; // Word rows as "dense" bitarrays, "sparse" sorted qgram idxs, or "auto" by vocabulary size
+    int register_bits = 8; // Bits per qgram sketch register, 6 or 4 pack them tighter with the same estimates
+    int threads = 1; // Threads sharing a batch of autocorrect/top3 queries, 0 for all hardware threads
+    bool intra_query = false; // Split a single query's words over the threads when the batch is too small to fill them
+    int intra_query_min_words = 1000000; // Dictionaries below this stay serial per query
+    size_t cache_capacity = 0; // Query answers kept for repeated queries, 0 for no cache
+    std::filesystem::path typo_table = "None"; // Precomputed answers from build_typo_table, ignored unless built for this dictionary and cfg
 } AutocorrectorCfg;
 
 typedef struct WordData {
@@ -46,6 +68,46 @@ typedef struct SingleResult {
     std::unordered_map<std::string, double> scores;
 } Result;
 
+typedef struct PruneStats {
+    long long words = 0; // Live words the queries were checked against
+    long long size_pruned = 0; // Words dropped by the |W| bounds before any intersection
+    long long prefix_skipped = 0; // Posting entries in suffix lists that could not start a candidate
+    long long jaccard_pruned = 0; // Intersected words whose Jaccard stayed below the lowest tau
+    long long scored = 0; // Candidates left for scoring
+    long long fallbacks = 0; // Queries with no candidate reaching the lowest tau, rerun unpruned
+    long long dp_cells = 0; // Keyboard edit distance cells filled by autocorrect
+    long long dp_cells_saved = 0; // Cells a full DP per candidate would have filled on top
+} PruneStats;
+
+typedef struct QueryScratch {
+    std::vector<int> posting_counts; // Merging postings, all zeros between queries, sized by the first query that does
+    PruneStats stats;
+    bool split = false; // Split this query's words and candidates over the pool
+} QueryScratch;
+
+typedef struct QueryContext {
+    std::vector<QueryScratch> scratches; // One per pool participant that can run a query (just one without a pool), kept between calls
+    PruneStats stats; // Of the latest call through this context
+    double query_seconds = 0.0; // Of the latest call, answering the queries
+    double output_seconds = 0.0; // Writing output_file
+} QueryContext;
+
+typedef struct ScoredWord {
+    int idx;
+    double jaccard;
+    double base; // (J + alpha * Zipf) * length penalty
+    double bonus; // 1 for the query itself
+    double score; // base + keyboard term + bonus, -inf if never needed
+    int tau_rank; // First (highest) tau passed
+} ScoredWord;
+
+typedef struct QueryAnswer {
+    std::vector<std::string> suggestions;
+    std::vector<double> scores;
+    std::string line; // Line in output_file
+    std::string details; // print_details text
+} QueryAnswer;
+
 struct Coord {
     int x;
     int y;
@@ -53,71 +115,115 @@ struct Coord {
 
 // ======== FUNCTION PROTOTYPES ======== //
 std::vector<std::string> extract_qgrams(std::string& word, int q = 2, bool fuzzier = false);
+std::vector<QgramCode> extract_qgram_codes(const std::string& word, bool fuzzier = false);
+size_t extract_qgram_codes(std::string_view word, QgramCode* out, size_t capacity, bool fuzzier = false); // Writes up to capacity codes, returns how many the word has
 
-bool is_valid(std::string& word, std::unordered_set<char> letters = {});
+bool is_valid(const std::string& word, const std::unordered_set<char>& letters = {});
 WordData load_words(std::vector<std::string>& arr, std::unordered_set<char> letters = {});
 WordData load_words(std::string& str, std::unordered_set<char> letters = {}); // Either is a file path or a single string input
 WordData load_words(StrVec sv, std::unordered_set<char> letters = {});
+WordData load_word_file(const std::filesystem::path& path, const std::unordered_set<char>& letters = {}, ThreadPool* pool = nullptr); // Mapped and parsed in parallel chunks, same words as load_words over its lines
 
 std::vector<std::pair<std::string, std::string>> load_queries(std::vector<std::string>& arr, std::unordered_set<char> letters = {});
 std::vector<std::pair<std::string, std::string>> load_queries(std::string& str, std::unordered_set<char> letters = {}); // Either is a file path or a single string input
 std::vector<std::pair<std::string, std::string>> load_queries(StrVec sv, std::unordered_set<char> letters = {});
 
-inline int popcount64(uint64_t x);
-
 // ======== CLASS ======== //
 class Autocorrector {
 public:
-    explicit Autocorrector(AutocorrectorCfg& cfg);
+    explicit Autocorrector(const AutocorrectorCfg& cfg);
     Autocorrector& operator=(const Autocorrector& ac) = default;
     explicit Autocorrector(StrVec _dictionary_list = (std::filesystem::path("test_files") / "20k_shun4midx.txt").string(), StrVec _valid_letters = "a-z", StrVec _keyboard = "qwerty", double _alpha = 0.2, double _beta = 0.35, int _b = 10);
 
     void save_dictionary();
     std::vector<std::string> add_dictionary(StrVec to_be_added);
     std::vector<std::string> remove_dictionary(StrVec to_be_removed);
-
-    Result autocorrect(const std::initializer_list<std::string> queries_list, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false);
-    Results top3(const std::initializer_list<std::string> queries_list, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false);
-
-    Result autocorrect(const StrVec& queries_list, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false);
-    Results top3(const StrVec& queries_list, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false);
+    void set_threads(int threads); // Same as AutocorrectorCfg::threads
+    PruneStats prune_stats() const; // Of this thread's latest call without its own QueryContext, see QueryContext::stats for those
+    CacheStats cache_stats() const; // Since construction, all zeros without a cache
+
+    void build_typo_table(const StrVec& typos, std::filesystem::path table_file, int k = 3, bool use_keyboard = true, size_t max_typos = 0); // typos most frequent first, max_typos 0 keeps all
+    bool load_typo_table(std::filesystem::path table_file); // False (and not used) if built for another dictionary or cfg
+    uint64_t fingerprint() const; // Of everything the suggestions and scores depend on
+
+    // Binary snapshot of the whole index. from_snapshot maps it and queries straight from the mapped pages;
+    // cfg only supplies the runtime options (threads, cache, pruning, ...), the dictionary and scoring come from the file.
+    // Ids and offsets are always range checked. verify_checksum also hashes every byte first, the slow path.
+    void save_snapshot(std::filesystem::path snapshot_file) const;
+    static Autocorrector from_snapshot(std::filesystem::path snapshot_file, const AutocorrectorCfg& cfg = AutocorrectorCfg(), bool verify_checksum = false);
+
+    Result autocorrect(const std::initializer_list<std::string> queries_list, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false) const;
+    Results top3(const std::initializer_list<std::string> queries_list, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false) const;
+    Results top_k(const std::initializer_list<std::string> queries_list, int k, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false) const;
+
+    Result autocorrect(const StrVec& queries_list, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false) const;
+    Results top3(const StrVec& queries_list, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false) const;
+    Results top_k(const StrVec& queries_list, int k, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false) const; // k suggestions per query, 1 <= k <= 50
+
+    // Same calls with a caller-owned context for the scratch space, stats and timings. The ones above use one per
+    // calling thread, so either way a single Autocorrector can serve every thread at once.
+    Result autocorrect(const StrVec& queries_list, QueryContext& ctx, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false) const;
+    Results top3(const StrVec& queries_list, QueryContext& ctx, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false) const;
+    Results top_k(const StrVec& queries_list, int k, QueryContext& ctx, std::filesystem::path output_file = "None", bool use_keyboard = true, bool return_invalid_words = true, bool print_details = false, bool print_times = false) const;
+
+    // Streaming: reads queries from in chunk_size lines at a time and writes each chunk's output_file lines to out before
+    // reading on, so memory stays at one chunk. The returned maps stay empty unless collect_results.
+    Result autocorrect_stream(std::istream& in, std::ostream& out, bool use_keyboard = true, bool return_invalid_words = true, size_t chunk_size = 4096, bool collect_results = false) const;
+    Results top_k_stream(std::istream& in, std::ostream& out, int k, bool use_keyboard = true, bool return_invalid_words = true, size_t chunk_size = 4096, bool collect_results = false) const;
 
 private:
     // ~~~~~~~~ VARIABLES ~~~~~~~~ //
     std::unordered_set<char> letters;
     std::vector<std::string> keyboard;
     std::unordered_map<char, struct Coord> KEY_POS;
-
-    std::vector<std::string> word_dict;
-    std::unordered_set<std::string> word_set;
-    std::unordered_map<std::string, std::string> display_map;
+    std::array<uint8_t, 256> key_slot; // Byte to its (lowercased) key position's slot
+    int key_slots = 0;
+    std::vector<double> key_dists; // key_slots x key_slots distances between key positions
 
     double alpha;
     double beta;
     int b;
 
-    std::unordered_set<std::string> removed_words;
-    double compact_threshold = 0.1;
-
-    std::chrono::steady_clock::time_point start_total, t0, t1, t2, t3, end_total;
+    // The published index. Queries pin one for the whole call; add/remove/save_dictionary edit an unpublished
+    // copy and publish it, so readers never wait for a writer.
+    Rcu<DictionaryIndex> index;
+    std::shared_ptr<DictionaryIndex> spare; // The index published before, reused once no query holds it
+    IndexEdit spare_edit; // The edit spare still lacks
 
-    int q;
-    SketchConfig cfg;
-    std::unordered_map<std::string, HyperLogLog> qgram_sketches; // Qgram to HLL
+    bool use_postings = true;
 
-    int WORD_COUNT;
-    int NUM_BUCKETS;
-    int BUCKET_SIZE;
+    bool use_pruning = false;
 
-    std::vector<std::string> all_qgrams;
-    std::unordered_map<std::string, int> qgram_idx; // Qgram to idx
-    int TOTAL_QGRAMS;
+    std::shared_ptr<ThreadPool> pool; // Null when serial
+    bool intra_query = false;
+    int intra_query_min_words = 1000000;
 
-    std::vector<std::vector<uint64_t>> word_bits;
+    std::shared_ptr<ResultCache<QueryAnswer>> cache; // Null without cache_capacity
+    std::shared_ptr<const TypoTable> typo_table; // Null unless loaded, and again after any dictionary edit
 
     // ~~~~~~~~ FUNCTIONS ~~~~~~~~ //
-    double key_dist(char& a, char& b);
-    double word_dist(const std::string& a, const std::string& b);
-    bool is_valid(std::string& word);
+    Autocorrector(std::shared_ptr<const MappedFile> file, const AutocorrectorCfg& cfg, bool verify_checksum); // from_snapshot
+    void set_options(const AutocorrectorCfg& cfg); // Runtime options, shared by both constructors
+    void build_key_slots(); // key_slot and key_dists from keyboard
+    std::vector<std::string> edit_index(const IndexEdit& edit, std::shared_ptr<const TypoTable> table = nullptr); // Applies edit to a copy, publishes it with table and returns edit's result
+    void publish_index(std::shared_ptr<DictionaryIndex> ix); // New version, answering from typo_table if set
+    uint64_t fingerprint(const DictionaryIndex& ix) const;
+
+    Results run_top_k(const StrVec& queries_list, int k, bool best_only, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times, QueryContext& ctx) const; // best_only: autocorrect's pick as the single word
+    Results run_stream(std::istream& in, std::ostream& out, int k, bool best_only, bool use_keyboard, bool return_invalid_words, size_t chunk_size, bool collect_results, QueryContext& ctx) const;
+    QueryAnswer answer_query(const DictionaryIndex& ix, const std::string& query, const std::string& query_display, int k, bool best_only, bool use_keyboard, bool return_invalid_words, bool print_details, QueryScratch& scratch) const; // Typo table, then cache, then the engine
+    std::vector<QueryAnswer> run_queries(const DictionaryIndex& ix, const std::vector<std::pair<std::string, std::string>>& queries, const std::function<QueryAnswer(const std::string&, const std::string&, QueryScratch&)>& answer_query, QueryContext& ctx) const; // Also fills ctx.stats
+    QueryAnswer autocorrect_query(const DictionaryIndex& ix, const std::string& query, const std::string& query_display, bool use_keyboard, bool return_invalid_words, bool print_details, QueryScratch& scratch) const;
+    bool typo_table_answer(const TypoTable& table, const std::string& query, int k, bool best_only, bool use_keyboard, QueryAnswer& out) const; // False unless the table holds this exact call
+    QueryAnswer top_k_query(const DictionaryIndex& ix, const std::string& query, const std::string& query_display, int k, bool use_keyboard, bool return_invalid_words, bool print_details, QueryScratch& scratch) const;
+    std::vector<std::pair<int, int>> find_candidates(const DictionaryIndex& ix, const std::vector<int>& q_ids, const std::vector<uint64_t>& qb, QueryScratch& scratch, double min_jaccard = 0.0) const;
+    double jaccard(const DictionaryIndex& ix, int qb_count, int idx, int inter) const;
+    std::vector<ScoredWord> score_candidates(const DictionaryIndex& ix, const std::string& query, int qb_count, const std::vector<std::pair<int, int>>& cand_idxs, double min_jaccard, QueryScratch& scratch) const;
+    void score_keyboard(const DictionaryIndex& ix, const std::string& query, std::vector<ScoredWord>& words, bool use_keyboard, double no_keyboard_term, bool best_only, QueryScratch& scratch) const; // best_only leaves words that can't reach the best at -inf
+    int chunk_count(size_t n, const QueryScratch& scratch) const; // 1 unless the query is split
+    void run_chunks(int chunks, size_t n, const std::function<void(int, size_t, size_t)>& fn) const; // fn(chunk, lo, hi) over [0, n)
+    void word_dists(const DictionaryIndex& ix, const std::string& a, const std::vector<int>& idxs, double* out) const; // word_dist to each word_dict[idx], batched
+    std::vector<uint8_t> to_key_slots(std::string_view word) const;
+    bool is_valid(const std::string& word) const;
     std::vector<std::string> StrVecToVec(StrVec sv);
 };
\ No newline at end of file
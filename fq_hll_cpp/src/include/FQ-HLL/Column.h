@@ -0,0 +1,51 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ Header file               *
+ * File: Column.h                           *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// ======== CLASS ======== //
+// Flat array read by the query path: either an owned vector, or a read-only view into a mapped snapshot.
+// The first edit() of a view copies it into the vector, so mapped pages are never written.
+template <typename T, typename Alloc = std::allocator<T>>
+class Column {
+public:
+    using Vector = std::vector<T, Alloc>;
+
+    const T* data() const { return view ? view : owned.data(); }
+    size_t size() const { return view ? count : owned.size(); }
+    bool empty() const { return size() == 0; }
+    bool mapped() const { return view != nullptr; }
+
+    const T& operator[](size_t i) const { return data()[i]; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+
+    void map(const T* _view, size_t _count) {
+        owned = Vector();
+        view = _view;
+        count = _count;
+    }
+
+    Vector& edit() {
+        if (view) {
+            owned.assign(view, view + count);
+            view = nullptr;
+            count = 0;
+        }
+        return owned;
+    }
+
+private:
+    // ~~~~~~~~ VARIABLES ~~~~~~~~ //
+    Vector owned;
+    const T* view = nullptr; // Into the mapping, kept alive by the owner
+    size_t count = 0;
+};
@@ -0,0 +1,135 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ Header file               *
+ * File: DictionaryIndex.h                  *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#pragma once
+#include "AlignedAllocator.h"
+#include "Column.h"
+#include "HyperLogLog.h"
+#include "Snapshot.h"
+#include "TypoTable.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// ======== DEFINE ======== //
+using QgramCode = uint16_t; // A q = 2 gram packed as (first byte << 8) | second byte, ' ' pads
+static const int QGRAM_CODES = 1 << 16;
+using BitMatrix = std::vector<uint64_t, AlignedAllocator<uint64_t, 64>>; // Row-major, one cache-line aligned row per word
+
+// ======== FUNCTION PROTOTYPES ======== //
+std::string qgram_code_to_string(QgramCode code);
+
+// ======== TEMPLATES ======== //
+// Allocation-free q = 2 extraction: calls visit(code) for the same grams, in the same order, as extract_qgrams
+template <typename Visitor>
+inline void for_each_qgram_code(std::string_view word, bool fuzzier, Visitor&& visit) {
+    for (size_t i = 0; i + 1 < word.length(); ++i) {
+        QgramCode a = (unsigned char)(word[i]);
+        QgramCode c = (unsigned char)(word[i + 1]);
+
+        visit((QgramCode)((a << 8) | c));
+        visit((QgramCode)((a << 8) | c)); // Push again
+        visit((QgramCode)((a << 8) | ' '));
+        visit((QgramCode)((' ' << 8) | c));
+
+        if (fuzzier) {
+            visit((QgramCode)((c << 8) | a));
+        }
+    }
+}
+
+inline size_t qgram_code_count(size_t length, bool fuzzier = false) {
+    return length < 2 ? 0 : (length - 1) * (fuzzier ? 5 : 4);
+}
+
+// ======== CLASS ======== //
+// Everything a query reads: words, Zipf buckets, qgram sketches, rows and postings. An Autocorrector publishes
+// one immutable DictionaryIndex at a time; changes are applied to an unpublished copy and published whole.
+class DictionaryIndex {
+public:
+    DictionaryIndex() = default;
+    DictionaryIndex(std::vector<std::string> words, std::unordered_map<std::string, std::string> display, int b, const std::string& row_format, int register_bits = 8);
+
+    void rebuild(); // Sketches, rows and postings from word_dict
+    std::vector<std::string> add(const std::vector<std::string>& words, const std::unordered_map<std::string, std::string>& displays); // New words, then re-added ones
+    std::vector<std::string> remove(const std::vector<std::string>& words); // Tombstoned, compacted past compact_threshold
+    void unmap(); // Owned copies of everything a snapshot was viewing, before any change
+
+    int size() const; // Words, removed ones included
+    std::string_view word(int idx) const;
+    std::string_view display(int idx) const;
+    std::pair<const int*, const int*> postings(int qgram) const;
+    double qgram_estimate(int qgram) const;
+    bool is_removed(int idx) const;
+
+private:
+    friend class Autocorrector; // Queries and snapshots read the columns directly
+
+    // ~~~~~~~~ VARIABLES ~~~~~~~~ //
+    std::vector<std::string> word_dict; // Empty while mapped, see word()
+    std::unordered_set<std::string> word_set;
+    std::unordered_map<std::string, std::string> display_map;
+
+    Column<uint64_t> tombstones; // Bit i set while word i is removed, the scans AND it out a block at a time
+    int removed_count = 0;
+    double compact_threshold = 0.1; // Fraction of removed words that triggers compaction
+
+    int b = 10;
+    int register_bits = 8;
+    int q = 2;
+    SketchConfig cfg;
+    std::vector<HyperLogLog> qgram_sketches; // Qgram idx to HLL, empty while mapped
+
+    int WORD_COUNT = 0;
+    int NUM_BUCKETS = 0;
+    int BUCKET_SIZE = 0;
+
+    Column<QgramCode> all_qgrams; // Qgram idx to code, idxs in order of first appearance
+    Column<int> qgram_idx; // Qgram code to idx (-1 if unseen), direct-indexed
+    int TOTAL_QGRAMS = 0;
+
+    Column<uint64_t, BitMatrix::allocator_type> word_bits;
+    int row_stride = 0; // uint64_t blocks per row, a multiple of 8 so every row starts on a cache line
+    bool sparse_rows = false;
+    std::string row_format = "auto";
+    Column<uint16_t> row_ids; // Sparse rows: every word's sorted qgram idxs, back to back
+    Column<uint32_t> row_offsets; // Word i's idxs are row_ids[row_offsets[i]] to row_ids[row_offsets[i + 1]]
+    Column<int> word_qgram_counts; // Distinct qgrams per word
+    Column<int> word_lengths;
+    std::vector<std::vector<int>> qgram_postings; // Qgram idx to word idxs containing it, empty while mapped
+
+    // Loaded from a snapshot and unchanged since: the columns above view the mapping, and these replace
+    // word_dict, display_map, qgram_postings and qgram_sketches. Any change copies everything out first.
+    std::shared_ptr<const MappedFile> snapshot;
+    Column<uint64_t> word_offsets; // Word i is word_chars[word_offsets[i]] to word_chars[word_offsets[i + 1]]
+    Column<char> word_chars;
+    Column<uint64_t> display_offsets; // Same layout for the display strings
+    Column<char> display_chars;
+    Column<uint32_t> posting_offsets; // Qgram i's postings are posting_words[posting_offsets[i]] to posting_words[posting_offsets[i + 1]]
+    Column<int> posting_words;
+    Column<uint8_t> sketch_registers; // TOTAL_QGRAMS sketches of 2^b registers, back to back
+
+    uint64_t dictionary_version = 0; // Unique per published index, cached answers of other versions miss
+    std::shared_ptr<const TypoTable> typo_table; // The loaded table until the dictionary is edited, else null
+    double sketch_seconds = 0.0; // Of the latest rebuild
+    double row_seconds = 0.0;
+
+    // ~~~~~~~~ FUNCTIONS ~~~~~~~~ //
+    int add_qgram(QgramCode code); // Its idx, the next free one if unseen
+    bool wants_sparse_rows(int total_qgrams) const; // row_format's choice for this many qgrams
+    void build_sketches(); // Zipf buckets and every qgram's sketch from word_dict
+    void set_row_stride(int blocks);
+    void append_word_row(std::string& word); // Bits, postings and metadata of a new last word
+    void set_removed(const std::unordered_set<std::string>& words, bool removed); // Every word_dict entry of words
+};
@@ -0,0 +1,28 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ Header file               *
+ * File: EditDistance.h                     *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// ~~~~~~~~ VARIABLES ~~~~~~~~ //
+static const int EDIT_BATCH_LANES = 8; // Candidates per batched DP
+
+// ======== FUNCTION PROTOTYPES ======== //
+// Weighted Levenshtein over key slots: substituting x by y costs sub[x * slots + y], inserting or deleting costs 1
+double key_edit_distance(const uint8_t* a, size_t na, const uint8_t* b, size_t nb, const double* sub, int slots);
+
+// Exact distance when it is <= cutoff, otherwise anything above cutoff. Only fills the diagonal band |i - j| <= cutoff,
+// since leaving it takes more indels than the cutoff allows, and gives up once a whole row is above it.
+// cells (if given) is increased by the number of DP cells filled.
+double key_edit_distance_bounded(const uint8_t* a, size_t na, const uint8_t* b, size_t nb, const double* sub, int slots, double cutoff, long long* cells = nullptr);
+
+// Same distance from a to each of bs[0..count), EDIT_BATCH_LANES candidates per DP, one in every SIMD lane.
+// Bit-identical to key_edit_distance, only adds and mins are vectorized.
+void key_edit_distance_batch(const uint8_t* a, size_t na, const uint8_t* const* bs, const size_t* nbs, size_t count, const double* sub, int slots, double* out);
+const char* edit_distance_kernel_name();
@@ -9,5 +9,13 @@
 #include "Autocorrector.h"
 #include "compare.h"
 #include "compare3.h"
+#include "DictionaryIndex.h"
 #include "Hasher.h"
-#include "HyperLogLog.h"
\ No newline at end of file
+#include "HyperLogLog.h"
+#include "EditDistance.h"
+#include "Popcount.h"
+#include "Rcu.h"
+#include "ResultCache.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
+#include "TypoTable.h"
\ No newline at end of file
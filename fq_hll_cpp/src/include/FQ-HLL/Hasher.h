@@ -16,4 +16,5 @@
 #endif
 
 // ======== FUNCTION PROTOTYPES ======== //
+uint64_t murmur3_64(const char* data, size_t len, uint64_t seed = 42);
 uint64_t str_to_u64(const std::string& str);
\ No newline at end of file
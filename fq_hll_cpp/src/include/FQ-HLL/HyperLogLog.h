@@ -19,34 +19,71 @@
 #include <algorithm>
 #include <string>
 
+// ======== FUNCTION PROTOTYPES ======== //
+const char* estimate_kernel_name(); // Register sum kernel picked from CPUID (AVX2 > portable table)
+
 // ======== STRUCTS AND CLASSES ======== //
 struct SketchConfig {
     int b = 10;
     double alpha_override = -1.0;
     uint64_t mask = 0xFFFFFFFFFFFFFFFF;
+    bool sparse = true; // Start as a sorted (index, rho) list, dense once that would outgrow the 2^b registers
+    int register_bits = 8; // Dense registers as bytes, or packed 6 or 4 bits each (values too big for the field kept aside)
 };
 
 class HyperLogLog {
 public:
     explicit HyperLogLog();
     explicit HyperLogLog(const SketchConfig& _cfg);
+    HyperLogLog(const SketchConfig& _cfg, const uint8_t* _registers); // Copies 2^b registers, kept sparse if few are set
     void insert(uint64_t hash);
     void insert(const std::string& str);
     void shifted_insert(uint64_t hash, int shift);
     void shifted_insert(const std::string& str, int shift);
     void merge(const HyperLogLog& other);
     double estimate() const;
+    static double estimate(const SketchConfig& cfg, const uint8_t* registers); // Of 2^b registers in place, without copying them
     void reset();
+    void compact(); // Merges pending sparse inserts and frees spare capacity
+    std::vector<uint8_t> get_registers() const; // All 2^b, expanded if sparse
+    void write_registers(uint8_t* out) const; // Same into out
+    bool is_sparse() const;
+    size_t register_bytes() const; // Heap bytes of the registers in either form
 
 private:
     // ~~~~~~~~ VARIABLES ~~~~~~~~ //
     SketchConfig cfg;
     int m;
     double alpha_m;
-    std::vector<uint8_t> registers;
+    std::vector<uint8_t> registers; // Dense form, empty while sparse or packed
+    size_t sparse_max = 0; // Entries past which the dense form is smaller
+
+    // Packed dense form (register_bits 6 or 4): 64 / register_bits fields per word, each holding register - base.
+    // A field of all ones means the register is in overflow instead.
+    int register_bits = 8; // Layout in use, cfg.register_bits until overflow would outgrow a byte per register
+    std::vector<uint64_t> packed;
+    int base = 0; // 4 bits: the smallest register, raised once none are left at it. 6 bits: always 0
+    int base_count = 0; // Registers at base
+    std::vector<uint32_t> overflow; // Sorted (index << 8) | value of every register with an all-ones field
+
+    // Sparse form: one (index << 8) | value entry per set register, sorted, plus inserts not merged in yet
+    bool sparse = false;
+    std::vector<uint32_t> entries;
+    std::vector<uint32_t> pending;
 
     // ~~~~~~~~ FUNCTIONS ~~~~~~~~ //
-    double compute_alpha();
+    static double compute_alpha(const SketchConfig& cfg, int m);
+    static double estimate_registers(const uint8_t* registers, int m, double alpha_m);
     uint8_t rho(uint64_t w_suffix) const;
-    uint8_t count_zero_registers() const;
+    void set_register(uint64_t j, int r);
+    void flush_pending(); // Sorts pending into entries, dense once past sparse_max entries
+    void to_dense();
+    void clear_dense(); // 2^b zero registers in the current layout
+    void assign_dense(const uint8_t* values); // 2^b registers in the current layout, 4 bits basing them at the smallest
+    void set_packed(uint64_t j, int r);
+    void rebase(); // Re-encodes with base at the smallest register, once none are left at the old one
+    void widen_if_overflowing(); // A byte per register once that takes less than the packed words and overflow
+    void merge_packed(const HyperLogLog& other); // Same layout, a word at a time, the lower base raised to the higher one
+    double estimate_packed() const;
+    const std::vector<uint32_t>& merged_entries(std::vector<uint32_t>& scratch) const; // entries with pending applied, without changing either
 };
\ No newline at end of file
@@ -0,0 +1,17 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ Header file               *
+ * File: Intersect.h                        *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// ======== FUNCTION PROTOTYPES ======== //
+// All take strictly increasing id arrays and return |a ∩ b|
+int intersect_count_merge(const uint16_t* a, size_t na, const uint16_t* b, size_t nb);
+int intersect_count_gallop(const uint16_t* small, size_t ns, const uint16_t* large, size_t nl);
+int intersect_count(const uint16_t* a, size_t na, const uint16_t* b, size_t nb); // Picks SIMD compare, galloping or merge by size
@@ -0,0 +1,18 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ Header file               *
+ * File: Popcount.h                         *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// ======== FUNCTION PROTOTYPES ======== //
+// Kernels are picked once at runtime from CPUID (AVX-512 VPOPCNTDQ > AVX2 > POPCNT > portable),
+// so a plain -O2 build still runs the fastest one the host supports
+int popcount_words(const uint64_t* a, size_t n); // Sum of popcount(a[i])
+int and_popcount_words(const uint64_t* a, const uint64_t* b, size_t n); // Sum of popcount(a[i] & b[i])
+const char* popcount_kernel_name();
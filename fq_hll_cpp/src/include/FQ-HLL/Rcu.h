@@ -0,0 +1,86 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ Header file               *
+ * File: Rcu.h                              *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// ======== CLASS ======== //
+// Read-copy-update cell holding an immutable, reference-counted value. load() never locks: it pins the current
+// epoch, takes a reference to the value and unpins, so a reader keeps its version for as long as it likes.
+// publish() swaps the value in and waits out one grace period (readers pinned at the old epoch, which only ever
+// hold the pin for a reference count increment) before releasing its own reference to the old one.
+template <typename T>
+class Rcu {
+public:
+    Rcu() = default;
+    explicit Rcu(std::shared_ptr<const T> value) : current(new std::shared_ptr<const T>(std::move(value))) {}
+    Rcu(const Rcu& other) : Rcu(other.load()) {} // Shares the value, never the epochs or writers
+    ~Rcu() {
+        delete current.load();
+    }
+
+    Rcu& operator=(const Rcu& other) {
+        if (this != &other) {
+            publish(other.load());
+        }
+        return *this;
+    }
+
+    std::shared_ptr<const T> load() const {
+        uint64_t e;
+        while (true) {
+            e = epoch.load();
+            pinned[e & 1].count.fetch_add(1);
+            if (epoch.load() == e) {
+                break;
+            }
+            pinned[e & 1].count.fetch_sub(1); // A publish flipped the epoch in between, its grace period may be over
+        }
+
+        const std::shared_ptr<const T>* holder = current.load();
+        std::shared_ptr<const T> value = (holder ? *holder : nullptr);
+        pinned[e & 1].count.fetch_sub(1);
+        return value;
+    }
+
+    void publish(std::shared_ptr<const T> value) {
+        std::shared_ptr<const T>* next = new std::shared_ptr<const T>(std::move(value));
+
+        std::lock_guard<std::mutex> lock(publish_m);
+        const std::shared_ptr<const T>* old = current.exchange(next);
+
+        // Whoever could still be copying old pinned the epoch before this flip
+        uint64_t e = epoch.fetch_add(1);
+        while (pinned[e & 1].count.load() != 0) {
+            std::this_thread::yield();
+        }
+        delete old;
+    }
+
+    // Read-modify-publish sequences hold this so they never interleave, publish() alone doesn't need it
+    std::unique_lock<std::mutex> write_lock() {
+        return std::unique_lock<std::mutex>(write_m);
+    }
+
+private:
+    // ~~~~~~~~ VARIABLES ~~~~~~~~ //
+    struct alignas(64) Pin {
+        std::atomic<int64_t> count{0};
+    };
+
+    std::atomic<const std::shared_ptr<const T>*> current{nullptr};
+    mutable std::atomic<uint64_t> epoch{0};
+    mutable Pin pinned[2]; // Readers inside load(), by epoch parity
+    std::mutex publish_m;
+    std::mutex write_m;
+};
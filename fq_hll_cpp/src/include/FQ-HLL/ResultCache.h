@@ -0,0 +1,126 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ Header file               *
+ * File: ResultCache.h                      *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ======== STRUCTS ======== //
+typedef struct CacheStats {
+    long long hits = 0;
+    long long misses = 0; // Stale entries (older dictionary version) included
+    long long evictions = 0;
+} CacheStats;
+
+// ======== CLASS ======== //
+// Bounded cache, sharded by key hash. Lookups only take a shard's shared lock and mark the entry referenced,
+// inserts take it exclusively and evict with CLOCK (second chance) once the shard is full. Every entry
+// carries the version it was computed under, and only a lookup with the same version hits, so bumping
+// the version invalidates everything at once.
+template <typename Value>
+class ResultCache {
+public:
+    explicit ResultCache(size_t capacity, int max_shards = 16) {
+        int n = (int)std::max<size_t>(1, std::min<size_t>(max_shards, capacity));
+        size_t per_shard = (capacity + n - 1) / n;
+
+        for (int i = 0; i < n; ++i) {
+            shards.push_back(std::make_unique<Shard>(per_shard));
+        }
+    }
+
+    bool get(const std::string& key, uint64_t version, Value& out) {
+        Shard& shard = shard_of(key);
+        std::shared_lock<std::shared_mutex> lock(shard.m);
+
+        auto it = shard.slots.find(key);
+        if (it == shard.slots.end() || shard.entries[it->second].version != version) {
+            ++misses;
+            return false;
+        }
+
+        Entry& entry = shard.entries[it->second];
+        entry.referenced.store(true, std::memory_order_relaxed);
+        out = entry.value;
+        ++hits;
+        return true;
+    }
+
+    void put(const std::string& key, uint64_t version, const Value& value) {
+        Shard& shard = shard_of(key);
+        std::unique_lock<std::shared_mutex> lock(shard.m);
+
+        size_t slot;
+        auto it = shard.slots.find(key);
+        if (it != shard.slots.end()) {
+            slot = it->second;
+        } else if (shard.used < shard.entries.size()) {
+            slot = shard.used++;
+            shard.slots[key] = slot;
+        } else {
+            // Second chance: skip (and clear) referenced entries until an unreferenced one comes up
+            while (shard.entries[shard.hand].referenced.exchange(false, std::memory_order_relaxed)) {
+                shard.hand = (shard.hand + 1) % shard.entries.size();
+            }
+            slot = shard.hand;
+            shard.hand = (shard.hand + 1) % shard.entries.size();
+
+            shard.slots.erase(shard.entries[slot].key);
+            shard.slots[key] = slot;
+            ++evictions;
+        }
+
+        Entry& entry = shard.entries[slot];
+        entry.key = key;
+        entry.version = version;
+        entry.value = value;
+        entry.referenced.store(false, std::memory_order_relaxed);
+    }
+
+    CacheStats stats() const {
+        return CacheStats{hits.load(), misses.load(), evictions.load()};
+    }
+
+private:
+    // ~~~~~~~~ VARIABLES ~~~~~~~~ //
+    struct Entry {
+        std::string key;
+        uint64_t version = 0;
+        Value value;
+        std::atomic<bool> referenced{false};
+    };
+
+    struct Shard {
+        explicit Shard(size_t capacity) : entries(std::max<size_t>(1, capacity)) {}
+
+        std::shared_mutex m;
+        std::unordered_map<std::string, size_t> slots; // Key to its entry
+        std::vector<Entry> entries; // Fixed size, the first `used` are filled
+        size_t used = 0;
+        size_t hand = 0; // CLOCK hand
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<long long> hits{0};
+    std::atomic<long long> misses{0};
+    std::atomic<long long> evictions{0};
+
+    // ~~~~~~~~ FUNCTIONS ~~~~~~~~ //
+    Shard& shard_of(const std::string& key) {
+        return *shards[std::hash<std::string>{}(key) % shards.size()];
+    }
+};
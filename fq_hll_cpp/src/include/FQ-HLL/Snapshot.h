@@ -0,0 +1,103 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ Header file               *
+ * File: Snapshot.h                         *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#pragma once
+#include "Hasher.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ~~~~~~~~ VARIABLES ~~~~~~~~ //
+static const uint32_t SNAPSHOT_VERSION = 2; // Bump whenever a section's layout changes
+static const size_t SNAPSHOT_ALIGN = 64; // Every section starts on a cache line
+
+// Sections of an Autocorrector snapshot, in file order
+enum SnapshotSection : uint32_t {
+    SNAP_META,
+    SNAP_LETTERS,
+    SNAP_KEYBOARD_OFFSETS, SNAP_KEYBOARD_CHARS,
+    SNAP_WORD_OFFSETS, SNAP_WORD_CHARS,
+    SNAP_DISPLAY_OFFSETS, SNAP_DISPLAY_CHARS,
+    SNAP_ALL_QGRAMS,
+    SNAP_QGRAM_IDX,
+    SNAP_WORD_BITS,
+    SNAP_ROW_IDS,
+    SNAP_ROW_OFFSETS,
+    SNAP_QGRAM_COUNTS,
+    SNAP_WORD_LENGTHS,
+    SNAP_POSTING_OFFSETS, SNAP_POSTING_WORDS,
+    SNAP_REGISTERS,
+    SNAP_TOMBSTONES,
+    SNAP_SECTIONS
+};
+
+// ======== CLASSES ======== //
+// Read-only mapping of a whole file (read into memory where mmap is unavailable)
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path); // Throws if it can't be opened or mapped
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const;
+    size_t size() const;
+
+private:
+    // ~~~~~~~~ VARIABLES ~~~~~~~~ //
+    const char* base = nullptr;
+    size_t bytes = 0;
+    std::vector<uint64_t> buffer; // Only without mmap, 8-byte aligned
+};
+
+// Layout (host byte order): header | section table | sections, each SNAPSHOT_ALIGN aligned.
+// The checksum covers everything after the header, so with verify_checksum a corrupted file never loads.
+class SnapshotWriter {
+public:
+    template <typename T>
+    void add(SnapshotSection id, const T* data, size_t count) {
+        sections[id] = {(const char*)(data), count * sizeof(T)};
+    }
+
+    template <typename Container>
+    void add(SnapshotSection id, const Container& c) {
+        add(id, c.data(), c.size());
+    }
+
+    void write(const std::filesystem::path& path) const; // The added data must still be alive
+
+private:
+    // ~~~~~~~~ VARIABLES ~~~~~~~~ //
+    std::pair<const char*, size_t> sections[SNAP_SECTIONS] = {};
+};
+
+class SnapshotReader {
+public:
+    // Throws std::runtime_error unless the header, size and section table are those of a snapshot of this version and
+    // byte order. verify_checksum also hashes every byte after the header against the stored checksum.
+    SnapshotReader(std::shared_ptr<const MappedFile> file, bool verify_checksum = false);
+
+    template <typename T>
+    std::pair<const T*, size_t> section(SnapshotSection id) const {
+        auto [offset, bytes] = sections[id];
+        if (bytes % sizeof(T) != 0) {
+            throw std::runtime_error("Corrupt snapshot section " + std::to_string(id));
+        }
+        return {(const T*)(file->data() + offset), bytes / sizeof(T)};
+    }
+
+private:
+    // ~~~~~~~~ VARIABLES ~~~~~~~~ //
+    std::shared_ptr<const MappedFile> file;
+    std::pair<uint64_t, uint64_t> sections[SNAP_SECTIONS]; // Offset and bytes
+};
@@ -0,0 +1,69 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ Header file               *
+ * File: ThreadPool.h                       *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ======== CLASS ======== //
+// Work-stealing pool: every participant owns a deque of index ranges, pops its own from the back and steals
+// from the front of the others' once it runs dry, so uneven task costs still balance out
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads); // Total participants, the calling thread included
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const;
+
+    // Runs fn(i, participant) for every i in [0, n), in chunks of grain, and returns once all are done.
+    // participant is in [0, size()), so callers can keep per-participant scratch. Rethrows the first exception.
+    // While another thread's batch has the workers, the whole batch runs on the calling thread as participant 0.
+    void parallel_for(size_t n, const std::function<void(size_t, int)>& fn, size_t grain = 1);
+
+private:
+    // ~~~~~~~~ VARIABLES ~~~~~~~~ //
+    // A range carries its batch's fn, so a worker still draining the last batch never needs shared state to run it
+    struct Task {
+        size_t begin;
+        size_t end;
+        const std::function<void(size_t, int)>* fn;
+    };
+
+    struct TaskQueue {
+        std::mutex m;
+        std::deque<Task> ranges;
+    };
+
+    int participants;
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex m;
+    std::condition_variable cv_work;
+    std::condition_variable cv_done;
+    size_t generation = 0;
+    size_t pending = 0; // Ranges not finished yet
+    bool stopping = false;
+    std::exception_ptr error;
+
+    std::mutex batch_m; // Held by the one parallel_for using the workers
+
+    // ~~~~~~~~ FUNCTIONS ~~~~~~~~ //
+    bool run_one(int self);
+    void worker_loop(int self);
+};
@@ -0,0 +1,67 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ Header file               *
+ * File: TypoTable.h                        *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#pragma once
+#include "Hasher.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ======== STRUCTS ======== //
+typedef struct TypoEntry {
+    std::string best; // autocorrect's pick
+    double best_score = 0.0;
+    std::vector<std::string> suggestions; // top_k's k suggestions
+    std::vector<double> scores;
+} TypoEntry;
+
+// ======== CLASS ======== //
+// Immutable typo -> answer table, built offline and read back whole. Layout (host byte order):
+//   header | slots (open addressing, power of two, half full at most) | entries
+// A slot holds a typo's hash and the offset of its entry, an entry its typo, best pick and k suggestions,
+// so a lookup is one hash, usually one probe and one string compare.
+class TypoTable {
+public:
+    explicit TypoTable(const std::filesystem::path& path); // Throws if unreadable or not a table
+
+    static void write(const std::filesystem::path& path, uint64_t fingerprint, int k, bool use_keyboard, const std::vector<std::pair<std::string, TypoEntry>>& entries);
+
+    bool find(const std::string& typo, TypoEntry& out) const;
+
+    uint64_t fingerprint() const; // Of the dictionary and configuration the answers were computed under
+    int k() const;
+    bool use_keyboard() const;
+    size_t size() const;
+
+private:
+    // ~~~~~~~~ VARIABLES ~~~~~~~~ //
+    struct Header {
+        char magic[8];
+        uint32_t byte_order; // TYPO_TABLE_BYTE_ORDER as written
+        uint32_t k;
+        uint64_t fingerprint;
+        uint32_t use_keyboard;
+        uint32_t entries;
+        uint64_t slots;
+        uint64_t bytes; // Of the entries
+    };
+
+    struct Slot {
+        uint64_t hash;
+        uint64_t offset; // Into the entries, EMPTY_SLOT if unused
+    };
+
+    std::vector<char> data;
+    Header header;
+
+    // ~~~~~~~~ FUNCTIONS ~~~~~~~~ //
+    const Slot* slots() const;
+    const char* entries() const;
+};
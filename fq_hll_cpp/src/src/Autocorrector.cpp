@@ -8,6 +8,9 @@
 // ======== INCLUDE ======== //
 #include "../include/FQ-HLL/Autocorrector.h"
 
+// ~~~~~~~~ VARIABLES ~~~~~~~~ //
+static const size_t LOAD_MIN_CHUNK = 1 << 20; // Bytes of dictionary text per parsing chunk
+
 // ======== FUNCTIONS ======== //
 std::vector<std::string> extract_qgrams(std::string& word, int q, bool fuzzier) {
     if (word.length() < q) {
@@ -16,25 +19,43 @@ std::vector<std::string> extract_qgrams(std::string& word, int q, bool fuzzier)
 
     std::vector<std::string> qgrams;
 
+    if (q == 2) {
+        qgrams.reserve(qgram_code_count(word.length(), fuzzier));
+        for_each_qgram_code(word, fuzzier, [&](QgramCode code) {
+            qgrams.push_back(qgram_code_to_string(code));
+        });
+        return qgrams;
+    }
+
     for (int i = 0; i < word.length() - q + 1; ++i) {
-        std::string qgram = word.substr(i, q);
-        qgrams.push_back(qgram);
-
-        if (q == 2) {
-            qgrams.push_back(qgram); // Push again
-            qgrams.push_back(std::string(1, qgram[0]) + " ");
-            qgrams.push_back(" " + std::string(1, qgram[1]));
-            
-            if (fuzzier) {
-                qgrams.push_back(std::string(1, qgram[1]) + std::string(1, qgram[0]));
-            }
-        }
+        qgrams.push_back(word.substr(i, q));
     }
 
     return qgrams;
 }
 
-bool is_valid(std::string& word, std::unordered_set<char> letters) {
+std::vector<QgramCode> extract_qgram_codes(const std::string& word, bool fuzzier) {
+    std::vector<QgramCode> codes(qgram_code_count(word.length(), fuzzier));
+    extract_qgram_codes(word, codes.data(), codes.size(), fuzzier);
+    return codes;
+}
+
+size_t extract_qgram_codes(std::string_view word, QgramCode* out, size_t capacity, bool fuzzier) {
+    size_t n = 0;
+    for_each_qgram_code(word, fuzzier, [&](QgramCode code) {
+        if (n < capacity) {
+            out[n] = code;
+        }
+        ++n;
+    });
+    return n;
+}
+
+std::string qgram_code_to_string(QgramCode code) {
+    return std::string{(char)(code >> 8), (char)(code & 0xFF)};
+}
+
+bool is_valid(const std::string& word, const std::unordered_set<char>& letters) {
     if (letters.empty()) {
         return true;
     } else {
@@ -70,28 +91,105 @@ WordData load_words(std::vector<std::string>& arr, std::unordered_set<char> lett
 }
 
 WordData load_words(std::string& str, std::unordered_set<char> letters) { // Either is a file path or a single string input
-    std::vector<std::string> raw;
-
-    // Process
     std::filesystem::path p{str};
     if (std::filesystem::exists(p) && std::filesystem::is_regular_file(p)) {
-        std::ifstream in{p};
-        if (!in) {
-            throw std::runtime_error("Cannot open dictionary file: " + str);
-        }
-        
-        std::string line;
-        while (std::getline(in, line)) {
-            if (!line.empty()) {
-                raw.push_back(line);
+        return load_word_file(p, letters);
+    }
+
+    // Treat the string as one word
+    std::vector<std::string> raw = {str};
+    return load_words(raw, letters);
+}
+
+WordData load_word_file(const std::filesystem::path& path, const std::unordered_set<char>& letters, ThreadPool* pool) {
+    std::error_code ec;
+    if (std::filesystem::file_size(path, ec) == 0 && !ec) { // Nothing to map
+        return WordData{};
+    }
+
+    MappedFile file(path);
+    const char* text = file.data();
+    size_t size = file.size();
+
+    // Byte tables instead of is_valid's set lookups and std::tolower calls per char
+    std::array<char, 256> lower;
+    std::array<bool, 256> allowed;
+    for (int c = 0; c < 256; ++c) {
+        lower[c] = (char)(std::tolower(c));
+        allowed[c] = letters.empty() || letters.count(lower[c]) > 0;
+    }
+
+    // Chunks start right after a newline, so no line is split
+    size_t chunks = std::max<size_t>(1, std::min<size_t>(size / LOAD_MIN_CHUNK, pool ? pool->size() * 4 : 1));
+    std::vector<size_t> starts(chunks + 1, size);
+    starts[0] = 0;
+    for (size_t c = 1; c < chunks; ++c) {
+        const char* nl = (const char*)(std::memchr(text + c * size / chunks, '\n', size - c * size / chunks));
+        starts[c] = std::max(starts[c - 1], nl ? (size_t)(nl - text) + 1 : size);
+    }
+
+    // Per chunk: valid lines back to back, as typed and lowercased, plus where each ends
+    struct ParsedChunk {
+        std::string raw;
+        std::string lowered;
+        std::vector<size_t> ends;
+    };
+    std::vector<ParsedChunk> parsed(chunks);
+
+    auto parse = [&](size_t c, int) {
+        ParsedChunk& out = parsed[c];
+        out.raw.reserve(starts[c + 1] - starts[c]);
+        out.lowered.reserve(starts[c + 1] - starts[c]);
+
+        for (size_t pos = starts[c]; pos < starts[c + 1];) {
+            const char* nl = (const char*)(std::memchr(text + pos, '\n', starts[c + 1] - pos));
+            size_t end = (nl ? (size_t)(nl - text) : starts[c + 1]);
+
+            // Same lines as std::getline: '\r' stays, empty lines are skipped
+            bool valid = end > pos;
+            for (size_t i = pos; i < end && valid; ++i) {
+                valid = allowed[(unsigned char)(text[i])];
             }
+
+            if (valid) {
+                out.raw.append(text + pos, end - pos);
+                for (size_t i = pos; i < end; ++i) {
+                    out.lowered.push_back(lower[(unsigned char)(text[i])]);
+                }
+                out.ends.push_back(out.raw.size());
+            }
+            pos = end + 1;
+        }
+    };
+
+    if (pool && chunks > 1) {
+        pool->parallel_for(chunks, parse);
+    } else {
+        for (size_t c = 0; c < chunks; ++c) {
+            parse(c, 0);
         }
-    } else { // Treat the string as one word
-        raw.push_back(str);
     }
 
-    // Call
-    return load_words(raw, letters);
+    // One pass in file order, so a later duplicate's display wins like in load_words
+    size_t total = 0;
+    for (const ParsedChunk& chunk : parsed) {
+        total += chunk.ends.size();
+    }
+
+    WordData wd;
+    wd.words.reserve(total);
+    wd.display.reserve(total);
+
+    for (const ParsedChunk& chunk : parsed) {
+        size_t begin = 0;
+        for (size_t end : chunk.ends) {
+            wd.words.emplace_back(chunk.lowered, begin, end - begin);
+            wd.display[wd.words.back()].assign(chunk.raw, begin, end - begin);
+            begin = end;
+        }
+    }
+
+    return wd;
 }
 
 WordData load_words(StrVec sv, std::unordered_set<char> letters) {
@@ -157,16 +255,81 @@ std::vector<std::pair<std::string, std::string>> load_queries(StrVec sv, std::un
     }
 }
 
-inline int popcount64(uint64_t x) { 
-    return __builtin_popcountll(x);
+static const std::vector<double> TAU_CANDS = {0.8, 0.7, 0.6, 0.5, 0.4}; // Descending, autocorrect's tau sweep
+static const int MAX_TOP_K = 50;
+static const int SHORTLIST_PER_K = 10; // top_k rescores 10k candidates with the keyboard (30 for top3, as before)
+static const double SCORE_EPS = 1e-9; // Slack on score bounds, so rounding never prunes a tie
+static const size_t SPLIT_MIN_CHUNK = 4096; // Words or candidates per chunk of a split query, below that scheduling costs more than it saves
+
+static inline int lowest_bit(uint64_t x) { // x != 0
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// Higher score, then higher tau, then the more frequent word
+static bool better_scored(const ScoredWord& a, const ScoredWord& b) {
+    if (a.score != b.score) {
+        return a.score > b.score;
+    }
+    if (a.tau_rank != b.tau_rank) {
+        return a.tau_rank < b.tau_rank;
+    }
+    return a.idx < b.idx;
+}
+
+// Unique across all instances, so copies sharing a cache never mix up their dictionaries
+static uint64_t next_dictionary_version() {
+    static std::atomic<uint64_t> next{1};
+    return next++;
+}
+
+// Scalars of a snapshot's SNAP_META section
+typedef struct SnapshotMeta {
+    double alpha;
+    double beta;
+    double compact_threshold;
+    int32_t b;
+    int32_t q;
+    int32_t word_count;
+    int32_t num_buckets;
+    int32_t bucket_size;
+    int32_t total_qgrams;
+    int32_t row_stride;
+    int32_t sparse_rows;
+    int32_t row_format; // 0 auto, 1 dense, 2 sparse
+} SnapshotMeta;
+
+// Context of the calls that don't pass their own, one per calling thread
+static QueryContext& thread_context() {
+    static thread_local QueryContext ctx;
+    return ctx;
+}
+
+static void merge_stats(PruneStats& into, const PruneStats& from) {
+    into.words += from.words;
+    into.size_pruned += from.size_pruned;
+    into.prefix_skipped += from.prefix_skipped;
+    into.jaccard_pruned += from.jaccard_pruned;
+    into.scored += from.scored;
+    into.fallbacks += from.fallbacks;
+    into.dp_cells += from.dp_cells;
+    into.dp_cells_saved += from.dp_cells_saved;
 }
 
 // ======== Autocorrector CLASS: PUBLIC ======== //
-Autocorrector::Autocorrector(AutocorrectorCfg& cfg) : Autocorrector(cfg.dictionary_list, cfg.valid_letters, cfg.keyboard, cfg.alpha, cfg.beta, cfg.b) {}
+Autocorrector::Autocorrector(StrVec _dictionary_list, StrVec _valid_letters, StrVec _keyboard, double _alpha, double _beta, int _b) : Autocorrector(AutocorrectorCfg{_dictionary_list, _valid_letters, _keyboard, _alpha, _beta, _b}) {}
 
-Autocorrector::Autocorrector(StrVec _dictionary_list, StrVec _valid_letters, StrVec _keyboard, double _alpha, double _beta, int _b) {
+Autocorrector::Autocorrector(const AutocorrectorCfg& _cfg) {
     // Deal with allowed letters only
-    std::vector<std::string> normalized_letters = StrVecToVec(_valid_letters);
+    std::vector<std::string> normalized_letters = StrVecToVec(_cfg.valid_letters);
     if (!letters.empty()) {
         letters.clear();
     }
@@ -194,7 +357,7 @@ Autocorrector::Autocorrector(StrVec _dictionary_list, StrVec _valid_letters, Str
         keyboard.clear();
     }
 
-    if (auto p = std::get_if<std::string>(&_keyboard)) {
+    if (auto p = std::get_if<std::string>(&_cfg.keyboard)) {
         if (*p == "qwerty") {
             keyboard = {"1234567890", "qwertyuiop", "asdfghjkl", "zxcvbnm"};
         } else if (*p == "azerty") {
@@ -207,858 +370,1384 @@ Autocorrector::Autocorrector(StrVec _dictionary_list, StrVec _valid_letters, Str
             keyboard = {"1234567890", "qwfpgjluy", "arstdhneio", "zxcvbkm"};
         }
     } else {
-        keyboard = std::get<std::vector<std::string>>(_keyboard);
+        keyboard = std::get<std::vector<std::string>>(_cfg.keyboard);
     }
 
-    KEY_POS.clear();
+    build_key_slots();
 
-    for (int i = 0; i < keyboard.size(); ++i) {
-        for (int j = 0; j < keyboard[i].size(); ++j) {
-            KEY_POS[keyboard[i][j]].x = i;
-            KEY_POS[keyboard[i][j]].y = j;
-        }
-    }
+    // Deal with dictionary, files are parsed in parallel when there are threads
+    set_threads(_cfg.threads);
+    WordData wd;
 
-    // Deal with dictionary
-    std::vector<std::string> raw;
-    if (auto pvec = std::get_if<std::vector<std::string>>(&_dictionary_list)) {
-        raw = *pvec;
-    } else if (auto pstr = std::get_if<std::string>(&_dictionary_list)) {
+    if (auto pvec = std::get_if<std::vector<std::string>>(&_cfg.dictionary_list)) {
+        std::vector<std::string> raw = *pvec;
+        wd = load_words(raw, letters);
+    } else if (auto pstr = std::get_if<std::string>(&_cfg.dictionary_list)) {
         const std::string& key = *pstr;
-        
+        std::filesystem::path base_dir = std::filesystem::path(__FILE__).parent_path().parent_path();
+
         // Addon files
         if (std::find(addon_files.begin(), addon_files.end(), key) != addon_files.end()) {
-            std::filesystem::path base_dir = std::filesystem::path(__FILE__).parent_path().parent_path();
-            std::filesystem::path def_txt = base_dir / "test_files" / "20k_shun4midx.txt";
-            std::filesystem::path add_txt = base_dir / "test_files" / (key + ".txt");
-
-            auto load_into = [&](const std::filesystem::path& p) {
-                std::ifstream in{p};
-                if (!in) {
-                    throw std::runtime_error("Cannot open " + p.string());
-                }
-
-                std::string line;
-                while (std::getline(in, line)) {
-                    if (!line.empty()) {
-                        raw.push_back(line);
-                    }
-                }
-            };
+            wd = load_word_file(base_dir / "test_files" / "20k_shun4midx.txt", letters, pool.get());
 
-            load_into(def_txt);
-            load_into(add_txt);
+            // Appended, so a later duplicate's display wins as before
+            WordData addon = load_word_file(base_dir / "test_files" / (key + ".txt"), letters, pool.get());
+            wd.words.insert(wd.words.end(), std::make_move_iterator(addon.words.begin()), std::make_move_iterator(addon.words.end()));
+            for (auto& [word, shown] : addon.display) {
+                wd.display[word] = std::move(shown);
+            }
         } else { // Interpret as path
-            // If provided file path
             std::filesystem::path p{key};
 
             if (std::filesystem::exists(p) && std::filesystem::is_regular_file(p)) { // Direct file
-                std::ifstream in{p};
-                if (!in) {
-                    throw std::runtime_error("Cannot open " + p.string());
-                }
-
-                std::string line;
-                while (std::getline(in, line)) {
-                    if (!line.empty()) {
-                        raw.push_back(line);
-                    }
-                }
+                wd = load_word_file(p, letters, pool.get());
             } else { // Fallback relative to source
-                std::filesystem::path base_dir = std::filesystem::path(__FILE__).parent_path().parent_path();
                 std::filesystem::path rel = base_dir / key;
-                
+
                 if (!(std::filesystem::exists(rel) && std::filesystem::is_regular_file(rel))) {
                     throw std::runtime_error("Dictionary file not found: " + rel.string());
                 }
 
-                std::ifstream in{rel};
-                std::string line;
-                while (std::getline(in, line)) {
-                    if (!line.empty()) {
-                        raw.push_back(line);
-                    }
-                }
+                wd = load_word_file(rel, letters, pool.get());
             }
         }
     } else {
         throw std::invalid_argument("Invalid variant for dictionary_list");
     }
 
-    // Now actually parse, lower‐case, and filter via load_words(...) helper
-    WordData wd = load_words(raw, letters);
-    word_dict = std::move(wd.words);
-    display_map = std::move(wd.display);
+    alpha = _cfg.alpha;
+    beta = _cfg.beta;
+    b = _cfg.b;
 
-    word_set.clear();
-    word_set.reserve(word_dict.size());
-
-    for (auto& w : word_dict) {
-        word_set.insert(w);
+    if (_cfg.row_format != "auto" && _cfg.row_format != "dense" && _cfg.row_format != "sparse") {
+        throw std::invalid_argument("{row_format} should be one of auto, dense or sparse");
+    }
+    if (_cfg.register_bits != 8 && _cfg.register_bits != 6 && _cfg.register_bits != 4) {
+        throw std::invalid_argument("{register_bits} should be one of 8, 6 or 4");
     }
 
-    alpha = _alpha;
-    beta = _beta;
-    b = _b;
+    publish_index(std::make_shared<DictionaryIndex>(std::move(wd.words), std::move(wd.display), b, _cfg.row_format, _cfg.register_bits));
+    set_options(_cfg);
+}
 
-    save_dictionary();
+Autocorrector Autocorrector::from_snapshot(std::filesystem::path snapshot_file, const AutocorrectorCfg& cfg, bool verify_checksum) {
+    return Autocorrector(std::make_shared<const MappedFile>(snapshot_file), cfg, verify_checksum);
+}
 
-    if (!removed_words.empty()) {
-        removed_words.clear();
+void Autocorrector::save_snapshot(std::filesystem::path snapshot_file) const {
+    std::shared_ptr<const DictionaryIndex> pinned = index.load();
+    const DictionaryIndex& ix = *pinned;
+    SnapshotMeta meta{alpha, beta, ix.compact_threshold, b, ix.q, ix.WORD_COUNT, ix.NUM_BUCKETS, ix.BUCKET_SIZE, ix.TOTAL_QGRAMS, ix.row_stride, ix.sparse_rows, ix.row_format == "dense" ? 1 : (ix.row_format == "sparse" ? 2 : 0)};
+
+    std::vector<char> sorted_letters(letters.begin(), letters.end());
+    std::sort(sorted_letters.begin(), sorted_letters.end());
+
+    // Strings as one offsets array (n + 1 entries) and one array of their chars
+    auto string_table = [](size_t n, const std::function<std::string_view(size_t)>& at, std::vector<uint64_t>& offsets, std::string& chars) {
+        offsets.assign(1, 0);
+        for (size_t i = 0; i < n; ++i) {
+            chars += at(i);
+            offsets.push_back(chars.size());
+        }
+    };
+
+    int words = ix.size();
+    std::vector<uint64_t> keyboard_offsets, word_offs, display_offs;
+    std::string keyboard_chars, word_chs, display_chs;
+    string_table(keyboard.size(), [&](size_t i) { return std::string_view(keyboard[i]); }, keyboard_offsets, keyboard_chars);
+    string_table(words, [&](size_t i) { return ix.word(i); }, word_offs, word_chs);
+    string_table(words, [&](size_t i) { return ix.display(i); }, display_offs, display_chs);
+
+    // Postings and sketches flattened the same way
+    std::vector<uint32_t> post_offs(1, 0);
+    std::vector<int> post_words;
+    std::vector<uint8_t> registers;
+    for (int g = 0; g < ix.TOTAL_QGRAMS; ++g) {
+        auto [first, last] = ix.postings(g);
+        post_words.insert(post_words.end(), first, last);
+        post_offs.push_back(post_words.size());
     }
-    compact_threshold = 0.1;
+    if (ix.snapshot) {
+        registers.assign(ix.sketch_registers.begin(), ix.sketch_registers.end());
+    } else {
+        size_t m = (size_t)(1) << b;
+        registers.resize(ix.qgram_sketches.size() * m);
+        for (size_t g = 0; g < ix.qgram_sketches.size(); ++g) {
+            ix.qgram_sketches[g].write_registers(registers.data() + g * m);
+        }
+    }
+
+    SnapshotWriter writer;
+    writer.add(SNAP_META, &meta, 1);
+    writer.add(SNAP_LETTERS, sorted_letters);
+    writer.add(SNAP_KEYBOARD_OFFSETS, keyboard_offsets);
+    writer.add(SNAP_KEYBOARD_CHARS, keyboard_chars);
+    writer.add(SNAP_WORD_OFFSETS, word_offs);
+    writer.add(SNAP_WORD_CHARS, word_chs);
+    writer.add(SNAP_DISPLAY_OFFSETS, display_offs);
+    writer.add(SNAP_DISPLAY_CHARS, display_chs);
+    writer.add(SNAP_TOMBSTONES, ix.tombstones);
+    writer.add(SNAP_ALL_QGRAMS, ix.all_qgrams);
+    writer.add(SNAP_QGRAM_IDX, ix.qgram_idx);
+    writer.add(SNAP_WORD_BITS, ix.word_bits);
+    writer.add(SNAP_ROW_IDS, ix.row_ids);
+    writer.add(SNAP_ROW_OFFSETS, ix.row_offsets);
+    writer.add(SNAP_QGRAM_COUNTS, ix.word_qgram_counts);
+    writer.add(SNAP_WORD_LENGTHS, ix.word_lengths);
+    writer.add(SNAP_POSTING_OFFSETS, post_offs);
+    writer.add(SNAP_POSTING_WORDS, post_words);
+    writer.add(SNAP_REGISTERS, registers);
+    writer.write(snapshot_file);
 }
 
 
 void Autocorrector::save_dictionary() {
-    start_total = std::chrono::steady_clock::now();
-    t0 = std::chrono::steady_clock::now();
+    uint64_t version = next_dictionary_version();
+    edit_index([version](DictionaryIndex& ix) {
+        ix.rebuild();
+        ix.dictionary_version = version;
+        return std::vector<std::string>();
+    });
+}
 
-    q = 2;
-    cfg = SketchConfig{};
-    cfg.b = b;
-    
-    if (!qgram_sketches.empty()) {
-        qgram_sketches.clear();
-    }
+std::vector<std::string> Autocorrector::add_dictionary(StrVec to_be_added) {
+    WordData worddata = load_words(to_be_added, letters);
 
-    WORD_COUNT = word_dict.size();
-    NUM_BUCKETS = 1 << ((int)(std::ceil(std::log2((double)(WORD_COUNT)) / 2.0)));
-    BUCKET_SIZE = (int)(std::ceil(WORD_COUNT / NUM_BUCKETS));
+    uint64_t version = next_dictionary_version();
+    return edit_index([worddata, version](DictionaryIndex& ix) {
+        std::vector<std::string> added = ix.add(worddata.words, worddata.display);
+        ix.dictionary_version = version;
+        return added;
+    });
+}
 
-    // Build FQ-HLL per q-gram
-    for (int i = 0; i < word_dict.size(); ++i) {
-        std::vector<std::string> qgrams = extract_qgrams(word_dict[i], q, false);
+std::vector<std::string> Autocorrector::remove_dictionary(StrVec to_be_removed) {
+    WordData tbr = load_words(to_be_removed, letters);
 
-        // For fuzzy-HLL: shift by Zipf bucket, more shift = more common
-        int bucket_idx = (int)std::min(NUM_BUCKETS, (int)((i + 1) / BUCKET_SIZE) + 1);
-        int shift = (int)std::min((int)(std::floor(std::log2((double)(NUM_BUCKETS) / (double)(bucket_idx)))) * 4, 64);
+    uint64_t version = next_dictionary_version();
+    return edit_index([words = tbr.words, version](DictionaryIndex& ix) {
+        std::vector<std::string> removed = ix.remove(words);
+        ix.dictionary_version = version;
+        return removed;
+    });
+}
 
-        for (std::string& gram : qgrams) {
-            if (qgram_sketches.count(gram) == 0) {
-                qgram_sketches[gram] = HyperLogLog(cfg);
-            }
-            qgram_sketches[gram].shifted_insert(gram + "_" + word_dict[i], shift);
-        }
+void Autocorrector::set_threads(int threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
     }
 
-    // Precompute dict-word q gram sets for Jaccard
-    t1 = std::chrono::steady_clock::now();
+    if (threads <= 1) {
+        pool.reset();
+    } else if (!pool || pool->size() != threads) {
+        pool = std::make_shared<ThreadPool>(threads);
+    }
+}
+
+CacheStats Autocorrector::cache_stats() const {
+    return (cache ? cache->stats() : CacheStats{});
+}
 
-    all_qgrams.clear();
-    all_qgrams.reserve(qgram_sketches.size());
+PruneStats Autocorrector::prune_stats() const {
+    return thread_context().stats; // Per thread, so queries never share anything just to count
+}
 
-    for (auto& [gram, sketch] : qgram_sketches) {
-        all_qgrams.push_back(gram);
+void Autocorrector::build_typo_table(const StrVec& typos, std::filesystem::path table_file, int k, bool use_keyboard, size_t max_typos) {
+    if (k < 1 || k > MAX_TOP_K) {
+        throw std::invalid_argument("build_typo_table: k must be between 1 and " + std::to_string(MAX_TOP_K) + ", got " + std::to_string(k));
     }
-    std::sort(all_qgrams.begin(), all_qgrams.end());
 
-    qgram_idx.clear();
-    qgram_idx.reserve(all_qgrams.size());
+    // Distinct valid typos, keeping the most frequent ones
+    std::vector<std::pair<std::string, std::string>> queries;
+    std::unordered_set<std::string> seen;
+    for (auto& [query, query_display] : load_queries(typos)) {
+        if (max_typos > 0 && queries.size() >= max_typos) {
+            break;
+        }
+        if (is_valid(query) && seen.insert(query).second) {
+            queries.push_back({query, query});
+        }
+    }
 
-    for (int i = 0; i < all_qgrams.size(); ++i) {
-        qgram_idx[all_qgrams[i]] = i;
+    // Run both engines exactly as autocorrect and top_k would, words without any overlap stay out of the table
+    std::shared_ptr<const DictionaryIndex> pinned = index.load();
+    const DictionaryIndex& ix = *pinned;
+    QueryContext build_ctx;
+    std::vector<QueryAnswer> best = run_queries(ix, queries, [&](const std::string& query, const std::string& query_display, QueryScratch& scratch) {
+        return autocorrect_query(ix, query, query_display, use_keyboard, false, false, scratch);
+    }, build_ctx);
+    std::vector<QueryAnswer> top = run_queries(ix, queries, [&](const std::string& query, const std::string& query_display, QueryScratch& scratch) {
+        return top_k_query(ix, query, query_display, k, use_keyboard, false, false, scratch);
+    }, build_ctx);
+
+    std::vector<std::pair<std::string, TypoEntry>> entries;
+    entries.reserve(queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        if (!top[i].suggestions[0].empty()) {
+            entries.push_back({queries[i].first, TypoEntry{best[i].suggestions[0], best[i].scores[0], top[i].suggestions, top[i].scores}});
+        }
     }
 
-    TOTAL_QGRAMS = all_qgrams.size();
+    TypoTable::write(table_file, fingerprint(ix), k, use_keyboard, entries);
+}
 
-    int N = TOTAL_QGRAMS;
-    int blocks = (N + 63) / 64;
-    word_bits.clear();
-    word_bits.reserve(word_dict.size());
+bool Autocorrector::load_typo_table(std::filesystem::path table_file) {
+    auto table = std::make_shared<const TypoTable>(table_file);
+    if (table->fingerprint() != fingerprint()) {
+        return false;
+    }
 
-    for (size_t i = 0; i < word_dict.size(); ++i) {
-        const auto& word = word_dict[i];
+    // Same index, republished with the table
+    edit_index([](DictionaryIndex&) {
+        return std::vector<std::string>();
+    }, table);
+    return true;
+}
 
-        std::vector<uint64_t> ba(blocks, 0ULL);
+uint64_t Autocorrector::fingerprint() const {
+    return fingerprint(*index.load());
+}
 
-        auto qgrams = extract_qgrams(word_dict[i], q, false);
-        for (auto& gram : qgrams) {
-            auto it = qgram_idx.find(gram);
+Result Autocorrector::autocorrect(const std::initializer_list<std::string> queries_list, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) const {
+    return autocorrect((std::vector<std::string>)(queries_list), output_file, use_keyboard, return_invalid_words, print_details, print_times);
+}
 
-            if (it == qgram_idx.end()) {
-                continue;
-            }
+Results Autocorrector::top3(const std::initializer_list<std::string> queries_list, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) const {
+    return top3((std::vector<std::string>)(queries_list), output_file, use_keyboard, return_invalid_words, print_details, print_times);
+}
 
-            size_t bit = it->second;  // Which bit to set
-            size_t blk = bit >> 6; // Which uint64_t
-            size_t off = bit & 0x3F;  // Which bit in that word
-            ba[blk] |= (1ULL << off);
-        }
+Results Autocorrector::top_k(const std::initializer_list<std::string> queries_list, int k, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) const {
+    return top_k((std::vector<std::string>)(queries_list), k, output_file, use_keyboard, return_invalid_words, print_details, print_times);
+}
 
-        word_bits.push_back(std::move(ba));
-    }
+
+Result Autocorrector::autocorrect(const StrVec& queries_list, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) const {
+    return autocorrect(queries_list, thread_context(), output_file, use_keyboard, return_invalid_words, print_details, print_times);
 }
 
-std::vector<std::string> Autocorrector::add_dictionary(StrVec to_be_added) {
-    WordData worddata = load_words(to_be_added, letters);
+Results Autocorrector::top3(const StrVec& queries_list, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) const {
+    return top3(queries_list, thread_context(), output_file, use_keyboard, return_invalid_words, print_details, print_times);
+}
 
-    std::vector<std::string> words = worddata.words;
-    std::unordered_map<std::string, std::string> displays = worddata.display;
-    
-    std::vector<std::string> added;
-    std::vector<std::string> remove_added;
+Results Autocorrector::top_k(const StrVec& queries_list, int k, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) const {
+    return top_k(queries_list, k, thread_context(), output_file, use_keyboard, return_invalid_words, print_details, print_times);
+}
 
-    for (auto& word : words) {
-        if (word_set.find(word) == word_set.end()) {
-            added.push_back(word);
-        } else {
-            removed_words.erase(word);
-            remove_added.push_back(word);
-        }
+Result Autocorrector::autocorrect(const StrVec& queries_list, QueryContext& ctx, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) const {
+    Results best = run_top_k(queries_list, 1, true, output_file, use_keyboard, return_invalid_words, print_details, print_times, ctx);
+
+    std::unordered_map<std::string, std::string> suggestions;
+    std::unordered_map<std::string, double> final_scores;
+    for (auto& [query, words] : best.suggestions) {
+        suggestions[query] = words[0];
+        final_scores[query] = best.scores[query][0];
     }
 
-    if (added.empty()) {
-        return remove_added;
+    return (Result){suggestions, final_scores};
+}
+
+Results Autocorrector::top3(const StrVec& queries_list, QueryContext& ctx, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) const {
+    return top_k(queries_list, 3, ctx, output_file, use_keyboard, return_invalid_words, print_details, print_times);
+}
+
+Results Autocorrector::top_k(const StrVec& queries_list, int k, QueryContext& ctx, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) const {
+    if (k < 1 || k > MAX_TOP_K) {
+        throw std::invalid_argument("top_k: k must be between 1 and " + std::to_string(MAX_TOP_K) + ", got " + std::to_string(k));
     }
 
-    int old_exp = std::log2(NUM_BUCKETS);
-    int new_exp = std::ceil(std::log2(word_dict.size() + added.size()) / 2);
+    return run_top_k(queries_list, k, false, output_file, use_keyboard, return_invalid_words, print_details, print_times, ctx);
+}
 
-    // 1) Full rebuild if exponent bumps
-    if (new_exp != old_exp) {
-        for (auto& add : added) {
-            word_dict.push_back(add);
-            word_set.insert(add);
-            display_map[add] = displays[add];
-        }
+Result Autocorrector::autocorrect_stream(std::istream& in, std::ostream& out, bool use_keyboard, bool return_invalid_words, size_t chunk_size, bool collect_results) const {
+    Results best = run_stream(in, out, 1, true, use_keyboard, return_invalid_words, chunk_size, collect_results, thread_context());
 
-        save_dictionary();
+    std::unordered_map<std::string, std::string> suggestions;
+    std::unordered_map<std::string, double> final_scores;
+    for (auto& [query, words] : best.suggestions) {
+        suggestions[query] = words[0];
+        final_scores[query] = best.scores[query][0];
+    }
 
-        for (std::string& str : remove_added) {
-            added.push_back(str);
-        }
+    return (Result){suggestions, final_scores};
+}
 
-        return added;
+Results Autocorrector::top_k_stream(std::istream& in, std::ostream& out, int k, bool use_keyboard, bool return_invalid_words, size_t chunk_size, bool collect_results) const {
+    if (k < 1 || k > MAX_TOP_K) {
+        throw std::invalid_argument("top_k_stream: k must be between 1 and " + std::to_string(MAX_TOP_K) + ", got " + std::to_string(k));
     }
 
-    // 2) Otherwise true O(1) per-word work:
-    // Recomupte NUM_BUCKETS (BUCKET_SIZE stays frozen)
-    NUM_BUCKETS = std::ceil((word_dict.size() + added.size()) / BUCKET_SIZE);
+    return run_stream(in, out, k, false, use_keyboard, return_invalid_words, chunk_size, collect_results, thread_context());
+}
 
-    // For each new word: update display_map, HLL sketches, and one bitarray
-    int base = word_dict.size();
+// ======== Autocorrector CLASS: PRIVATE ======== //
+Autocorrector::Autocorrector(std::shared_ptr<const MappedFile> file, const AutocorrectorCfg& _cfg, bool verify_checksum) {
+    if (_cfg.register_bits != 8 && _cfg.register_bits != 6 && _cfg.register_bits != 4) {
+        throw std::invalid_argument("{register_bits} should be one of 8, 6 or 4");
+    }
 
-    for (int i = 0; i < added.size(); ++i) {
-        word_dict.push_back(added[i]);
-        word_set.insert(added[i]);
-        display_map[added[i]] = displays[added[i]];
+    SnapshotReader reader(file, verify_checksum);
 
-        // Qgram sketches
-        std::vector<std::string> qgrams = extract_qgrams(added[i], q, false);
-        int bucket_idx = (base + i + 1) / BUCKET_SIZE + 1;
-        int shift = std::min((int)(std::floor(std::log2(NUM_BUCKETS / bucket_idx))) * 4, 64);
+    auto [meta, meta_count] = reader.section<SnapshotMeta>(SNAP_META);
+    if (meta_count != 1 || meta->b < 0 || meta->b > 16 || meta->word_count < 0 || meta->total_qgrams < 0 || meta->row_stride < 0 ||
+        (meta->word_count > 0 && (meta->num_buckets <= 0 || meta->bucket_size <= 0))) {
+        throw std::runtime_error("Corrupt snapshot metadata");
+    }
 
-        for (auto& gram : qgrams) {
-            auto [it, inserted] = qgram_sketches.try_emplace(gram, cfg);
-            HyperLogLog& sketch = it->second;
+    auto ix = std::make_shared<DictionaryIndex>();
+    alpha = meta->alpha;
+    beta = meta->beta;
+    b = meta->b;
+    ix->compact_threshold = meta->compact_threshold;
+    ix->b = meta->b;
+    ix->q = meta->q;
+    ix->WORD_COUNT = meta->word_count;
+    ix->NUM_BUCKETS = meta->num_buckets;
+    ix->BUCKET_SIZE = meta->bucket_size;
+    ix->TOTAL_QGRAMS = meta->total_qgrams;
+    ix->row_stride = meta->row_stride;
+    ix->sparse_rows = meta->sparse_rows;
+    ix->row_format = (meta->row_format == 1 ? "dense" : (meta->row_format == 2 ? "sparse" : "auto"));
+    ix->register_bits = _cfg.register_bits; // Snapshots keep a byte per register, packed again only if copied out
+    ix->cfg = SketchConfig{};
+    ix->cfg.b = b;
+    ix->cfg.register_bits = ix->register_bits;
+
+    // Small, so copied out
+    auto strings = [&](SnapshotSection offsets_id, SnapshotSection chars_id) {
+        auto [offsets, n] = reader.section<uint64_t>(offsets_id);
+        auto [chars, total] = reader.section<char>(chars_id);
+        std::vector<std::string> out;
+        for (size_t i = 0; i + 1 < n && offsets[i + 1] <= total; ++i) {
+            out.emplace_back(chars + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+        return out;
+    };
+
+    auto [letter_chars, letter_count] = reader.section<char>(SNAP_LETTERS);
+    letters = std::unordered_set<char>(letter_chars, letter_chars + letter_count);
+    keyboard = strings(SNAP_KEYBOARD_OFFSETS, SNAP_KEYBOARD_CHARS);
+    build_key_slots();
+
+    // Everything else is viewed in place
+    auto map_column = [&](auto& column, SnapshotSection id) {
+        using T = std::remove_const_t<std::remove_pointer_t<decltype(column.data())>>;
+        auto [data, n] = reader.section<T>(id);
+        column.map(data, n);
+    };
+
+    map_column(ix->word_offsets, SNAP_WORD_OFFSETS);
+    map_column(ix->word_chars, SNAP_WORD_CHARS);
+    map_column(ix->display_offsets, SNAP_DISPLAY_OFFSETS);
+    map_column(ix->display_chars, SNAP_DISPLAY_CHARS);
+    map_column(ix->all_qgrams, SNAP_ALL_QGRAMS);
+    map_column(ix->qgram_idx, SNAP_QGRAM_IDX);
+    map_column(ix->word_bits, SNAP_WORD_BITS);
+    map_column(ix->row_ids, SNAP_ROW_IDS);
+    map_column(ix->row_offsets, SNAP_ROW_OFFSETS);
+    map_column(ix->word_qgram_counts, SNAP_QGRAM_COUNTS);
+    map_column(ix->word_lengths, SNAP_WORD_LENGTHS);
+    map_column(ix->posting_offsets, SNAP_POSTING_OFFSETS);
+    map_column(ix->posting_words, SNAP_POSTING_WORDS);
+    map_column(ix->sketch_registers, SNAP_REGISTERS);
+    map_column(ix->tombstones, SNAP_TOMBSTONES);
+
+    // Sizes have to agree before any query indexes with them
+    size_t words = ix->word_lengths.size();
+    int total_qgrams = ix->TOTAL_QGRAMS;
+    bool consistent = words == (size_t)(ix->WORD_COUNT) && ix->word_qgram_counts.size() == words &&
+                      ix->word_offsets.size() == words + 1 && ix->word_offsets[words] == ix->word_chars.size() &&
+                      ix->display_offsets.size() == words + 1 && ix->display_offsets[words] == ix->display_chars.size() &&
+                      ix->qgram_idx.size() == (size_t)(QGRAM_CODES) && ix->all_qgrams.size() == (size_t)(total_qgrams) &&
+                      ix->posting_offsets.size() == (size_t)(total_qgrams) + 1 && ix->posting_offsets[total_qgrams] == ix->posting_words.size() &&
+                      ix->sketch_registers.size() == (size_t)(total_qgrams) << b && ix->tombstones.size() == (words + 63) / 64 &&
+                      (ix->sparse_rows ? ix->row_offsets.size() == words + 1 && ix->row_offsets[words] == ix->row_ids.size()
+                                       : ix->row_stride > 0 && ix->word_bits.size() == words * ix->row_stride);
+    if (!consistent) {
+        throw std::runtime_error("Corrupt snapshot: section sizes disagree");
+    }
 
-            sketch.shifted_insert(gram + "_" + added[i], shift);
+    // Every id and offset a query follows has to stay inside its section. One pass over each, which is far less
+    // than hashing the whole file (the registers, by far the largest section, hold no ids).
+    auto ascending = [](const auto& offsets) {
+        for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+            if (offsets[i] > offsets[i + 1]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto all_within = [](const auto& ids, int64_t lo, int64_t hi) {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (ids[i] < lo || ids[i] >= hi) {
+                return false;
+            }
         }
+        return true;
+    };
+
+    bool in_range = ascending(ix->word_offsets) && ascending(ix->display_offsets) && ascending(ix->posting_offsets) &&
+                    (!ix->sparse_rows || ascending(ix->row_offsets)) && all_within(ix->qgram_idx, -1, total_qgrams) &&
+                    all_within(ix->posting_words, 0, words) && (words % 64 == 0 || ix->tombstones[words / 64] >> (words % 64) == 0);
+    if (!in_range) {
+        throw std::runtime_error("Corrupt snapshot: ids or offsets out of range");
     }
 
-    // If new qgrams appeared, extend existing bitarrays by zeros
-    std::vector<std::string> new_all;
-    new_all.reserve(qgram_sketches.size());
-    for (auto& kv : qgram_sketches) {
-        new_all.push_back(kv.first);
+    ix->removed_count = popcount_words(ix->tombstones.data(), ix->tombstones.size());
+    ix->snapshot = file;
+    publish_index(ix);
+    set_options(_cfg);
+}
+
+void Autocorrector::set_options(const AutocorrectorCfg& _cfg) {
+    use_postings = _cfg.use_postings;
+    use_pruning = _cfg.use_pruning;
+    set_threads(_cfg.threads);
+    intra_query = _cfg.intra_query;
+    intra_query_min_words = _cfg.intra_query_min_words;
+    if (_cfg.cache_capacity > 0) {
+        cache = std::make_shared<ResultCache<QueryAnswer>>(_cfg.cache_capacity);
+    }
+
+    if (_cfg.typo_table != std::filesystem::path("None")) {
+        load_typo_table(_cfg.typo_table);
     }
-    std::sort(new_all.begin(), new_all.end());
+}
 
-    int delta = (int)new_all.size() - (int)all_qgrams.size();
-    if (delta > 0) {
-        int new_total  = new_all.size();
-        int new_blocks = (new_total + 63) / 64;
+void Autocorrector::build_key_slots() {
+    KEY_POS.clear();
 
-        for (auto& ba : word_bits) {
-            ba.resize(new_blocks, 0ULL);
+    for (int i = 0; i < keyboard.size(); ++i) {
+        for (int j = 0; j < keyboard[i].size(); ++j) {
+            KEY_POS[keyboard[i][j]].x = i;
+            KEY_POS[keyboard[i][j]].y = j;
         }
+    }
 
-        all_qgrams = std::move(new_all);
-        qgram_idx.clear();
-        qgram_idx.reserve(all_qgrams.size());
-        for (int i = 0; i < all_qgrams.size(); ++i) {
-            qgram_idx[all_qgrams[i]] = i;
+    // Every byte (lowercased first, as word_dist compares) gets the slot of its key position, missing keys
+    // sit at (0, 0), and key_dists holds all slot-to-slot distances so the DP never looks up KEY_POS
+    std::vector<Coord> slot_pos;
+    for (int c = 0; c < 256; ++c) {
+        char lc = std::tolower((char)(c));
+        Coord pos = {0, 0};
+        auto it = KEY_POS.find(lc);
+        if (it != KEY_POS.end()) {
+            pos = it->second;
         }
-        TOTAL_QGRAMS = all_qgrams.size();
-    }
-
-    // Finally append one bitarray per new word
-    int blocks = (TOTAL_QGRAMS + 63) / 64;
-    for (auto& w : added) {
-        std::vector<uint64_t> ba(blocks, 0ULL);
-    
-        std::vector<std::string> qgrams = extract_qgrams(w, q, false);
-        for (auto& gram : qgrams) {
-            auto it = qgram_idx.find(gram);
-            if (it == qgram_idx.end()) {
-                continue;
-            }
 
-            size_t bit = it->second; // Which bit
-            size_t blk = bit >> 6; // Bit / 64
-            size_t off = bit & 0x3F; // Bit % 64
-            ba[blk] |= (1ULL << off);
+        int slot = 0;
+        while (slot < slot_pos.size() && (slot_pos[slot].x != pos.x || slot_pos[slot].y != pos.y)) {
+            ++slot;
         }
-    
-        word_bits.push_back(std::move(ba));
+        if (slot == slot_pos.size()) {
+            slot_pos.push_back(pos);
+        }
+        key_slot[c] = slot;
     }
 
-    for (std::string& str : remove_added) {
-        added.push_back(str);
+    key_slots = slot_pos.size();
+    key_dists.assign(key_slots * key_slots, 0.0);
+    for (int i = 0; i < key_slots; ++i) {
+        for (int j = 0; j < key_slots; ++j) {
+            int dx = slot_pos[i].x - slot_pos[j].x;
+            int dy = slot_pos[i].y - slot_pos[j].y;
+            key_dists[i * key_slots + j] = std::sqrt(dx * dx + dy * dy);
+        }
     }
-
-    return added;
 }
 
-std::vector<std::string> Autocorrector::remove_dictionary(StrVec to_be_removed) {
-    WordData tbr = load_words(to_be_removed, letters);
-    std::vector<std::string> words = tbr.words;
+std::vector<std::string> Autocorrector::edit_index(const IndexEdit& edit, std::shared_ptr<const TypoTable> table) {
+    std::unique_lock<std::mutex> lock = index.write_lock();
+    typo_table = std::move(table);
+
+    // The index published before this one is only one edit behind; once the last query pinning it is done
+    // it is brought up to date in place instead of copying the whole index again
+    std::shared_ptr<DictionaryIndex> draft;
+    if (spare && spare.use_count() == 1) {
+        std::atomic_thread_fence(std::memory_order_acquire); // Pairs with the readers' releasing decrements
+        draft = std::move(spare);
+        spare_edit(*draft);
+    } else {
+        draft = std::make_shared<DictionaryIndex>(*index.load());
+    }
+    spare.reset();
 
-    std::vector<std::string> removed;
+    std::vector<std::string> result = edit(*draft);
+    std::shared_ptr<const DictionaryIndex> old = index.load();
+    publish_index(draft);
 
-    for (auto& word : words) {
-        if (word_set.find(word) != word_set.end()) {
-            removed_words.insert(word);
-            removed.push_back(word);
-        }
-    }
+    spare = std::const_pointer_cast<DictionaryIndex>(old);
+    spare_edit = edit;
+    return result;
+}
 
-    // If too many removed, full rebuild
-    size_t og_size = word_dict.size();
-    if (removed_words.size() >= og_size * compact_threshold) {
-        word_dict.erase(
-            std::remove_if(word_dict.begin(), word_dict.end(),
-              [&](auto& word){
-                if (removed_words.count(word)) {
-                  display_map.erase(word);
-                  word_set.erase(word);
-                  return true;
-                }
-                return false;
-              }),
-            word_dict.end()
-          );
-        
-        removed_words.clear();
-        save_dictionary();
+void Autocorrector::publish_index(std::shared_ptr<DictionaryIndex> ix) {
+    if (ix->dictionary_version == 0) {
+        ix->dictionary_version = next_dictionary_version();
     }
 
-    return removed;
+    // load_typo_table checked the fingerprint once, and any edit since has dropped the table
+    ix->typo_table = typo_table;
+    index.publish(std::move(ix));
 }
 
-Result Autocorrector::autocorrect(const std::initializer_list<std::string> queries_list, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) {
-    return autocorrect((std::vector<std::string>)(queries_list), output_file, use_keyboard, return_invalid_words, print_details, print_times);
-}
+uint64_t Autocorrector::fingerprint(const DictionaryIndex& ix) const {
+    std::ostringstream key;
+    key << std::setprecision(17) << "alpha " << alpha << " beta " << beta << " b " << b << " bucket " << ix.BUCKET_SIZE << "\n";
 
-Results Autocorrector::top3(const std::initializer_list<std::string> queries_list, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) {
-    return top3((std::vector<std::string>)(queries_list), output_file, use_keyboard, return_invalid_words, print_details, print_times);
-}
+    std::vector<char> sorted_letters(letters.begin(), letters.end());
+    std::sort(sorted_letters.begin(), sorted_letters.end());
+    key.write(sorted_letters.data(), sorted_letters.size());
+    key << "\n";
 
+    for (const std::string& row : keyboard) {
+        key << row << "\n";
+    }
 
-Result Autocorrector::autocorrect(const StrVec& queries_list, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) {
-    if (print_times) {
-        save_dictionary();
+    // Word idxs set the Zipf term, so removed words keep their place
+    for (int i = 0; i < ix.size(); ++i) {
+        if (ix.is_removed(i)) {
+            key << "\n";
+            continue;
+        }
+        key << ix.word(i) << " " << ix.display(i) << "\n";
     }
 
+    return str_to_u64(key.str());
+}
+
+Results Autocorrector::run_top_k(const StrVec& queries_list, int k, bool best_only, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times, QueryContext& ctx) const {
+    // Every query of the call sees this version, whatever writers publish meanwhile
+    std::shared_ptr<const DictionaryIndex> pinned = index.load();
+    const DictionaryIndex& ix = *pinned;
+
     std::vector<std::pair<std::string, std::string>> queries = load_queries(queries_list);
 
     // 3) Process queries
-    t2 = std::chrono::steady_clock::now();
+    auto t2 = std::chrono::steady_clock::now();
 
     std::vector<std::string> output;
-    std::unordered_map<std::string, std::string> suggestions;
-    std::unordered_map<std::string, double> final_scores;
+    std::unordered_map<std::string, std::vector<std::string>> suggestions;
+    std::unordered_map<std::string, std::vector<double>> final_scores;
 
-    for (auto& [query, query_display] : queries) {
-        if (!is_valid(query)) {
-            if (return_invalid_words) {
-                suggestions[query_display] = query_display;
-                final_scores[query_display] = 0.0;
-                output.push_back(query_display);
-                continue;
-            } else {
-                suggestions[query_display] = "";
-                final_scores[query_display] = 0.0;
-                output.push_back("");
-                continue;
-            }
-        }
+    std::vector<QueryAnswer> answers = run_queries(ix, queries, [&](const std::string& query, const std::string& query_display, QueryScratch& scratch) {
+        return answer_query(ix, query, query_display, k, best_only, use_keyboard, return_invalid_words, print_details, scratch);
+    }, ctx);
 
-        // Print fuzzy HLL estimates per gram
-        std::vector<std::string> Q_vec = extract_qgrams(query, q, true);
-        std::unordered_set<std::string> Q {Q_vec.begin(), Q_vec.end()};
+    for (int i = 0; i < queries.size(); ++i) {
+        const std::string& query_display = queries[i].second;
 
         if (print_details) {
-            std::cout << std::setw(12) << std::right << query << " -> qgrams: |";
-
-            for (const auto& gram : Q) {
-                auto it = qgram_sketches.find(gram);
-                double est = (it != qgram_sketches.end() ? it->second.estimate() : 0.0);
-                std::cout << gram << "(" << est << ")" << " |";
-            }
-
-            std::cout << "\n";
+            std::cout << answers[i].details;
         }
 
-        // Build query bitarray
-        int blocks = (TOTAL_QGRAMS + 63) / 64;
-        std::vector<uint64_t> qb(blocks, 0ULL);
+        suggestions[query_display] = std::move(answers[i].suggestions);
+        final_scores[query_display] = std::move(answers[i].scores);
+        output.push_back(std::move(answers[i].line));
+    }
 
-        for (auto& gram : Q) {
-            auto it = qgram_idx.find(gram);
-            if (it == qgram_idx.end()) {
-                continue;
-            }
+    // 4) Write out
+    auto t3 = std::chrono::steady_clock::now();
 
-            int bit = it->second;
-            int blk = bit >> 6;
-            int off = bit & 0x3F;
-            qb[blk] |= (1ULL << off);
-        }
+    if (output_file != std::filesystem::path("None")) {
+        std::ofstream out(output_file);
 
-        int qb_count = 0;
-        for (auto& block : qb) {
-            qb_count += popcount64(block);
+        if (!out) {
+            throw std::runtime_error("Failed to open output file: " + output_file.string());
         }
 
-        // Scan all words for candidates (intersecting grams >= 1)
-        std::vector<std::pair<int, int>> cand_idxs;
-        cand_idxs.reserve(word_bits.size());
-        for (int idx = 0; idx < word_bits.size(); ++idx) {
-            if (removed_words.find(word_dict[idx]) != removed_words.end()) {
-                continue;
+        for (int i = 0; i < output.size(); ++i) {
+            out << output[i];
+            if (i + 1 < output.size()) {
+                out << "\n";
             }
+        }
+    }
 
-            auto& wb = word_bits[idx];
-            int inter = 0;
-            for (int b = 0; b < blocks; ++b) {
-                inter += popcount64(wb[b] & qb[b]);
-            }
+    // 5) Output time elapsed
+    auto end_total = std::chrono::steady_clock::now();
 
-            if (inter > 0) {
-                cand_idxs.emplace_back(idx, inter);
+    ctx.query_seconds = std::chrono::duration<double>(t3 - t2).count();
+    ctx.output_seconds = std::chrono::duration<double>(end_total - t3).count();
+
+    // Building is timed once per index version, printing never rebuilds it
+    if (print_times) {
+        double dur_build_sketches = ix.sketch_seconds;
+        double dur_build_bitvectors = ix.row_seconds;
+        double dur_query_processing = ctx.query_seconds;
+        double dur_total = dur_build_sketches + dur_build_bitvectors + std::chrono::duration<double>(end_total - t2).count();
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Build sketches:    " << dur_build_sketches   << "s\n";
+        std::cout << "Build bit-vectors: " << dur_build_bitvectors << "s\n";
+        std::cout << "Query processing:  " << dur_query_processing << "s\n";
+        std::cout << "Total autocorrect: " << dur_total            << "s\n";
+
+        if (best_only && use_pruning) {
+            std::cout << "Pruned (size):     " << ctx.stats.size_pruned << " / " << ctx.stats.words << " words\n";
+            std::cout << "Pruned (prefix):   " << ctx.stats.prefix_skipped << " posting entries\n";
+            std::cout << "Pruned (Jaccard):  " << ctx.stats.jaccard_pruned << " words\n";
+            std::cout << "Scored:            " << ctx.stats.scored << " words (" << ctx.stats.fallbacks << " unpruned fallbacks)\n";
+            if (use_keyboard) {
+                std::cout << "Keyboard DP cells: " << ctx.stats.dp_cells << " (" << ctx.stats.dp_cells_saved << " saved by bounds)\n";
             }
         }
+    }
 
-        if (cand_idxs.empty()) {
-            if (return_invalid_words) {
-                if (print_details) {
-                    std::cout << "  -> no overlaps; returning original: " << query_display << std::endl;
-                }
-                suggestions[query_display] = query_display;
-                final_scores[query_display] = 0.0;
-                output.push_back(query_display);
-                continue;
-            } else {
-                if (print_details) {
-                    std::cout << "  -> no overlaps; returning empty" << std::endl;
-                }
-                suggestions[query_display] = "";
-                final_scores[query_display] = 0.0;
-                output.push_back("");
-                continue;
+    // Return
+    return (Results){suggestions, final_scores};
+}
+
+Results Autocorrector::run_stream(std::istream& in, std::ostream& out, int k, bool best_only, bool use_keyboard, bool return_invalid_words, size_t chunk_size, bool collect_results, QueryContext& ctx) const {
+    if (chunk_size == 0) {
+        throw std::invalid_argument("Streaming needs a chunk_size of at least 1");
+    }
+
+    std::unordered_map<std::string, std::vector<std::string>> suggestions;
+    std::unordered_map<std::string, std::vector<double>> final_scores;
+    PruneStats total;
+    bool first_line = true;
+
+    // Only one chunk of queries and answers is ever held
+    std::vector<std::string> raw;
+    raw.reserve(chunk_size);
+
+    for (bool more = true; more;) {
+        raw.clear();
+        std::string line;
+        while (raw.size() < chunk_size && (more = (bool)(std::getline(in, line)))) {
+            if (!line.empty()) {
+                raw.push_back(std::move(line));
             }
         }
 
-        // d) Compute Jaccard & Zipf score R for each candidate
-        std::unordered_map<int, double> J; // Jaccards
-        std::unordered_map<int, double> R; // Ranks
+        // Each chunk sees one version, a long stream picks up dictionary changes between chunks
+        std::shared_ptr<const DictionaryIndex> pinned = index.load();
+        const DictionaryIndex& ix = *pinned;
 
-        for (auto& [idx, inter] : cand_idxs) {
-            int word_ones = 0;
-            for (uint64_t block : word_bits[idx]) {
-                word_ones += popcount64(block);
+        std::vector<std::pair<std::string, std::string>> queries = load_queries(raw);
+        std::vector<QueryAnswer> answers = run_queries(ix, queries, [&](const std::string& query, const std::string& query_display, QueryScratch& scratch) {
+            return answer_query(ix, query, query_display, k, best_only, use_keyboard, return_invalid_words, false, scratch);
+        }, ctx);
+        merge_stats(total, ctx.stats);
+
+        // Same lines as output_file, newline separated
+        for (int i = 0; i < queries.size(); ++i) {
+            if (!first_line) {
+                out << "\n";
             }
+            out << answers[i].line;
+            first_line = false;
 
-            double uni = qb_count + word_ones - inter;
-            J[idx] = (uni != 0 ? (double)(inter) / uni : 0.0);
-            R[idx] = 1.0 / ((idx + 1) / BUCKET_SIZE + 1); // same Zipf normalization as before
+            if (collect_results) {
+                suggestions[queries[i].second] = std::move(answers[i].suggestions);
+                final_scores[queries[i].second] = std::move(answers[i].scores);
+            }
         }
+        out.flush();
 
-        // e) Sweep tau to pick best
-        int best_idx = -1;
-        double best_score = -1.0;
-        double best_tau = -1.0;
-
-        std::vector<double> tau_cands = {0.8, 0.7, 0.6, 0.5, 0.4};
-        for (double& tau : tau_cands) {
-            std::vector<int> passers;
-            passers.reserve(J.size());
-            for (auto& [idx, jval] : J) {
-                if (jval >= tau) {
-                    passers.push_back(idx);
-                }
-            }
+        if (!out) {
+            throw std::runtime_error("Failed to write streamed output");
+        }
+    }
 
-            if (passers.empty()) {
-                continue;
-            }
+    ctx.stats = total;
+    return (Results){suggestions, final_scores};
+}
 
-            for (int& idx : passers) {
-                double length_penalty = 1.0 - std::pow((double)(std::abs((int)(word_dict[idx].length()) - (int)(query.length()))) / (double)(query.length()), 2);
-                double norm_dist = (use_keyboard ? 1.0 / (1.0 + word_dist(query, word_dict[idx])) : 1);
-                double score = (J[idx] + alpha * R[idx]) * length_penalty + norm_dist * beta + (query == word_dict[idx] ? 1 : 0);
+QueryAnswer Autocorrector::answer_query(const DictionaryIndex& ix, const std::string& query, const std::string& query_display, int k, bool best_only, bool use_keyboard, bool return_invalid_words, bool print_details, QueryScratch& scratch) const {
+    // Precomputed and cached answers carry no details text, so print_details always recomputes
+    QueryAnswer precomputed;
+    if (ix.typo_table && !print_details && typo_table_answer(*ix.typo_table, query, k, best_only, use_keyboard, precomputed)) {
+        return precomputed;
+    }
 
-                // std::cout << word_dict[idx] << ": " << length_penalty << ", " << word_dict[idx].length() << ", " << query.length() << std::endl;
+    std::string key;
+    if (cache && !print_details) {
+        key = std::to_string(best_only ? 0 : k) + (use_keyboard ? "k" : "-") + (return_invalid_words ? "r" : "-") + "\n" + query + "\n" + query_display;
 
-                if (score > best_score) {
-                    best_score = score;
-                    best_idx = idx;
-                    best_tau = tau;
-                }
-            }
+        QueryAnswer cached;
+        if (cache->get(key, ix.dictionary_version, cached)) {
+            return cached;
         }
+    }
 
-        if (best_idx == -1) { // Fallback, take highest
-            for (auto& [idx, jval] : J) {
-                if (jval > best_score) {
-                    best_idx = idx;
-                    best_score = jval;
-                }
-            }
-            best_tau = 0.4;
+    QueryAnswer ans = (best_only ? autocorrect_query(ix, query, query_display, use_keyboard, return_invalid_words, print_details, scratch)
+                                 : top_k_query(ix, query, query_display, k, use_keyboard, return_invalid_words, print_details, scratch));
+
+    if (!key.empty()) {
+        cache->put(key, ix.dictionary_version, ans);
+    }
+    return ans;
+}
+
+std::vector<QueryAnswer> Autocorrector::run_queries(const DictionaryIndex& ix, const std::vector<std::pair<std::string, std::string>>& queries, const std::function<QueryAnswer(const std::string&, const std::string&, QueryScratch&)>& answer_query, QueryContext& ctx) const {
+    std::vector<QueryAnswer> answers(queries.size());
+
+    // Too few queries to keep every thread busy on a big dictionary: split each query's words instead
+    bool split = pool && intra_query && ix.word_lengths.size() >= intra_query_min_words && queries.size() < pool->size();
+
+    // One scratch per pool participant, owned by the caller's context so concurrent callers never share one. Split
+    // queries run on this thread and only spread their chunks, so they need just the one.
+    std::vector<QueryScratch>& scratches = ctx.scratches;
+    size_t participants = (pool && !split ? pool->size() : 1);
+    if (scratches.size() < participants) {
+        scratches.resize(participants);
+    }
+
+    for (size_t p = 0; p < participants; ++p) {
+        scratches[p].stats = PruneStats{};
+        scratches[p].split = split;
+    }
+
+    auto run = [&](size_t i, int self) {
+        answers[i] = answer_query(queries[i].first, queries[i].second, scratches[self]);
+    };
+
+    if (pool && !split) {
+        pool->parallel_for(queries.size(), run);
+    } else {
+        for (size_t i = 0; i < queries.size(); ++i) {
+            run(i, 0);
         }
+    }
 
-        std::string picked = word_dict[best_idx];
-        if (print_details) {
-            std::cout << std::setw(12) << std::right << query << " -> picked " << std::quoted(picked) << " at tau=" << best_tau
-                << "  (J=" << J[best_idx] << ", score=" << best_score << ")" << std::endl;
+    ctx.stats = PruneStats{};
+    for (size_t p = 0; p < participants; ++p) {
+        merge_stats(ctx.stats, scratches[p].stats);
+    }
 
-            std::cout << std::string(30, '-') << std::endl;
+    return answers;
+}
+
+bool Autocorrector::typo_table_answer(const TypoTable& table, const std::string& query, int k, bool best_only, bool use_keyboard, QueryAnswer& out) const {
+    if (use_keyboard != table.use_keyboard() || (!best_only && k != table.k())) {
+        return false;
+    }
+
+    TypoEntry entry;
+    if (!table.find(query, entry)) {
+        return false;
+    }
+
+    if (best_only) {
+        out = QueryAnswer{{entry.best}, {entry.best_score}, entry.best, ""};
+    } else {
+        std::string line = entry.suggestions[0];
+        for (int i = 1; i < k; ++i) {
+            line += " " + entry.suggestions[i];
         }
+        out = QueryAnswer{std::move(entry.suggestions), std::move(entry.scores), line, ""};
+    }
+    return true;
+}
+
+QueryAnswer Autocorrector::autocorrect_query(const DictionaryIndex& ix, const std::string& query, const std::string& query_display, bool use_keyboard, bool return_invalid_words, bool print_details, QueryScratch& scratch) const {
+    std::ostringstream details; // print_details text, printed in input order by the caller
+    details.copyfmt(std::cout);
+
+    auto answer = [&](std::vector<std::string> sug, std::vector<double> sc, std::string line) {
+        return QueryAnswer{std::move(sug), std::move(sc), std::move(line), details.str()};
+    };
 
-        std::string displayed_picked;
-        auto it = display_map.find(picked);
-        if (it != display_map.end()) {
-            displayed_picked = it->second;
+    if (!is_valid(query)) {
+        if (return_invalid_words) {
+            return answer({query_display}, {0.0}, query_display);
         } else {
-            displayed_picked = picked;
+            return answer({""}, {0.0}, "");
+        }
+    }
+
+    // Print fuzzy HLL estimates per gram
+    if (print_details) {
+        std::vector<QgramCode> Q = extract_qgram_codes(query, true);
+        std::sort(Q.begin(), Q.end());
+        Q.erase(std::unique(Q.begin(), Q.end()), Q.end());
+
+        details << std::setw(12) << std::right << query << " -> qgrams: |";
+
+        for (QgramCode code : Q) {
+            double est = (ix.qgram_idx[code] >= 0 ? ix.qgram_estimate(ix.qgram_idx[code]) : 0.0);
+            details << qgram_code_to_string(code) << "(" << est << ")" << " |";
         }
 
-        suggestions[query_display] = displayed_picked;
-        final_scores[query_display] = best_score;
-        output.push_back(displayed_picked);
+        details << "\n";
     }
 
-    // 4) Write out
-    t3 = std::chrono::steady_clock::now();
+    // Build query bitarray straight from the grams, the bits dedupe repeats
+    std::vector<uint64_t> qb(std::max(ix.row_stride, (ix.TOTAL_QGRAMS + 63) / 64), 0ULL);
+    std::vector<int> q_ids;
+    q_ids.reserve(qgram_code_count(query.length(), true));
 
-    if (output_file != std::filesystem::path("None")) {
-        std::ofstream out(output_file);
+    for_each_qgram_code(query, true, [&](QgramCode code) {
+        int bit = ix.qgram_idx[code];
+        if (bit < 0) {
+            return;
+        }
 
-        if (!out) {
-            throw std::runtime_error("Failed to open output file: " + output_file.string());
+        int blk = bit >> 6;
+        int off = bit & 0x3F;
+        if (!(qb[blk] & (1ULL << off))) {
+            qb[blk] |= (1ULL << off);
+            q_ids.push_back(bit);
         }
+    });
 
-        for (int i = 0; i < output.size(); ++i) {
-            out << output[i];
-            if (i + 1 < output.size()) {
-                out << "\n";
+    int qb_count = popcount_words(qb.data(), qb.size());
+
+    // Find candidates (intersecting grams >= 1), pruned to words that can reach the lowest tau
+    std::vector<std::pair<int, int>> cand_idxs = find_candidates(ix, q_ids, qb, scratch, use_pruning ? TAU_CANDS.back() : 0.0);
+
+    if (use_pruning && cand_idxs.empty()) { // The fallback below needs every overlapping word
+        ++scratch.stats.fallbacks;
+        cand_idxs = find_candidates(ix, q_ids, qb, scratch);
+    }
+
+    if (cand_idxs.empty()) {
+        if (return_invalid_words) {
+            if (print_details) {
+                details << "  -> no overlaps; returning original: " << query_display << std::endl;
             }
+            return answer({query_display}, {0.0}, query_display);
+        } else {
+            if (print_details) {
+                details << "  -> no overlaps; returning empty" << std::endl;
+            }
+            return answer({""}, {0.0}, "");
         }
     }
 
-    // 5) Output time elapsed
-    end_total = std::chrono::steady_clock::now();
+    // d) Score every candidate that passes the lowest tau once, keyboard distance only where it can still win
+    std::vector<ScoredWord> words = score_candidates(ix, query, qb_count, cand_idxs, TAU_CANDS.back(), scratch);
+    score_keyboard(ix, query, words, use_keyboard, beta, true, scratch);
 
-    if (print_times) {
-        double dur_build_sketches = std::chrono::duration<double>(t1 - t0).count();
-        double dur_build_bitvectors = std::chrono::duration<double>(t2 - t1).count();
-        double dur_query_processing = std::chrono::duration<double>(t3 - t2).count();
-        double dur_total = std::chrono::duration<double>(end_total - t0).count();
+    // e) The sweep over TAU_CANDS only keeps a strictly better score, so the pick is the best score overall,
+    // at the highest tau it passes (then the most frequent word), as long as it beats -1
+    const ScoredWord* best = nullptr;
+    for (const ScoredWord& word : words) {
+        if (word.score > -1.0 && (!best || better_scored(word, *best))) {
+            best = &word;
+        }
+    }
 
-        std::cout << std::fixed << std::setprecision(3);
-        std::cout << "Build sketches:    " << dur_build_sketches   << "s\n";
-        std::cout << "Build bit-vectors: " << dur_build_bitvectors << "s\n";
-        std::cout << "Query processing:  " << dur_query_processing << "s\n";
-        std::cout << "Total autocorrect: " << dur_total            << "s\n";
+    int best_idx;
+    double best_score, best_tau, best_jaccard;
+    if (best) {
+        best_idx = best->idx;
+        best_score = best->score;
+        best_tau = TAU_CANDS[best->tau_rank];
+        best_jaccard = best->jaccard;
+    } else { // Fallback, take highest Jaccard
+        best_idx = -1;
+        best_jaccard = -1.0;
+        for (auto& [idx, inter] : cand_idxs) {
+            double jval = jaccard(ix, qb_count, idx, inter);
+            if (jval > best_jaccard) {
+                best_idx = idx;
+                best_jaccard = jval;
+            }
+        }
+        best_score = best_jaccard;
+        best_tau = 0.4;
     }
 
-    // Return
-    return (Result){suggestions, final_scores};
-}
+    std::string picked(ix.word(best_idx));
+    if (print_details) {
+        details << std::setw(12) << std::right << query << " -> picked " << std::quoted(picked) << " at tau=" << best_tau
+            << "  (J=" << best_jaccard << ", score=" << best_score << ")" << std::endl;
 
-Results Autocorrector::top3(const StrVec& queries_list, std::filesystem::path output_file, bool use_keyboard, bool return_invalid_words, bool print_details, bool print_times) {
-    if (print_times) {
-        save_dictionary();
+        details << std::string(30, '-') << std::endl;
     }
 
-    std::vector<std::pair<std::string, std::string>> queries = load_queries(queries_list);
+    std::string displayed_picked(ix.display(best_idx));
 
-    // 3) Process queries
-    t2 = std::chrono::steady_clock::now();
+    return answer({displayed_picked}, {best_score}, displayed_picked);
+}
 
-    std::vector<std::string> output;
-    std::unordered_map<std::string, std::vector<std::string>> suggestions;
-    std::unordered_map<std::string, std::vector<double>> final_scores;
+QueryAnswer Autocorrector::top_k_query(const DictionaryIndex& ix, const std::string& query, const std::string& query_display, int k, bool use_keyboard, bool return_invalid_words, bool print_details, QueryScratch& scratch) const {
+    std::ostringstream details; // print_details text, printed in input order by the caller
+    details.copyfmt(std::cout);
 
-    for (auto& [query, query_display] : queries) {
-        if (!is_valid(query)) {
-            if (return_invalid_words) {
-                suggestions[query_display] = {query_display, "", ""};
-                final_scores[query_display] = {0.0, 0.0, 0.0};
-                output.push_back(query_display + "  ");
-                continue;
-            } else {
-                suggestions[query_display] = {"", "", ""};
-                final_scores[query_display] = {0.0, 0.0, 0.0};
-                output.push_back("");
-                continue;
-            }
-        }
+    auto answer = [&](std::vector<std::string> sug, std::vector<double> sc, std::string line) {
+        return QueryAnswer{std::move(sug), std::move(sc), std::move(line), details.str()};
+    };
 
-        // Print fuzzy HLL estimates per gram
-        std::vector<std::string> Q_vec = extract_qgrams(query, q, true);
-        std::unordered_set<std::string> Q {Q_vec.begin(), Q_vec.end()};
+    // Only the query (or nothing) in the first slot, k - 1 empty ones after
+    auto no_words = [&](const std::string& first, const std::string& line) {
+        std::vector<std::string> sug(k, "");
+        sug[0] = first;
+        return answer(sug, std::vector<double>(k, 0.0), line);
+    };
 
-        if (print_details) {
-            std::cout << std::setw(12) << std::right << query << " -> qgrams: |";
+    if (!is_valid(query)) {
+        if (return_invalid_words) {
+            return no_words(query_display, query_display + std::string(k - 1, ' '));
+        } else {
+            return no_words("", "");
+        }
+    }
 
-            for (const auto& gram : Q) {
-                auto it = qgram_sketches.find(gram);
-                double est = (it != qgram_sketches.end() ? it->second.estimate() : 0.0);
-                std::cout << gram << "(" << est << ")" << " |";
-            }
+    // Print fuzzy HLL estimates per gram
+    if (print_details) {
+        std::vector<QgramCode> Q = extract_qgram_codes(query, true);
+        std::sort(Q.begin(), Q.end());
+        Q.erase(std::unique(Q.begin(), Q.end()), Q.end());
+
+        details << std::setw(12) << std::right << query << " -> qgrams: |";
 
-            std::cout << "\n";
+        for (QgramCode code : Q) {
+            double est = (ix.qgram_idx[code] >= 0 ? ix.qgram_estimate(ix.qgram_idx[code]) : 0.0);
+            details << qgram_code_to_string(code) << "(" << est << ")" << " |";
         }
 
-        // Build query bitarray
-        int blocks = (TOTAL_QGRAMS + 63) / 64;
-        std::vector<uint64_t> qb(blocks, 0ULL);
+        details << "\n";
+    }
 
-        for (auto& gram : Q) {
-            auto it = qgram_idx.find(gram);
-            if (it == qgram_idx.end()) {
-                continue;
-            }
+    // Build query bitarray straight from the grams, the bits dedupe repeats
+    std::vector<uint64_t> qb(std::max(ix.row_stride, (ix.TOTAL_QGRAMS + 63) / 64), 0ULL);
+    std::vector<int> q_ids;
+    q_ids.reserve(qgram_code_count(query.length(), true));
 
-            int bit = it->second;
-            int blk = bit >> 6;
-            int off = bit & 0x3F;
-            qb[blk] |= (1ULL << off);
+    for_each_qgram_code(query, true, [&](QgramCode code) {
+        int bit = ix.qgram_idx[code];
+        if (bit < 0) {
+            return;
         }
 
-        int qb_count = 0;
-        for (auto& block : qb) {
-            qb_count += popcount64(block);
+        int blk = bit >> 6;
+        int off = bit & 0x3F;
+        if (!(qb[blk] & (1ULL << off))) {
+            qb[blk] |= (1ULL << off);
+            q_ids.push_back(bit);
         }
+    });
 
-        // Scan all words for candidates (intersecting grams >= 1)
-        std::vector<std::pair<int,int>> cand_idxs;
-        cand_idxs.reserve(word_bits.size());
-        for (int idx = 0; idx < word_bits.size(); ++idx) {
-            if (removed_words.count(word_dict[idx])) {
-                continue;
-            }
+    int qb_count = popcount_words(qb.data(), qb.size());
 
-            auto& wb = word_bits[idx];
-            int inter = 0;
-            for (int b = 0; b < blocks; ++b) {
-                inter += popcount64(wb[b] & qb[b]);
-            }
+    // Find candidates (intersecting grams >= 1)
+    std::vector<std::pair<int, int>> cand_idxs = find_candidates(ix, q_ids, qb, scratch);
 
-            if (inter > 0) {
-                cand_idxs.emplace_back(idx, inter);
+    if (cand_idxs.empty()) {
+        if (return_invalid_words) {
+            if (print_details) {
+                details << "  -> no overlaps; returning original: " << query_display << std::string(k - 1, ' ') << std::endl;
+            }
+            return no_words(query_display, query_display + std::string(k - 1, ' '));
+        } else {
+            if (print_details) {
+                details << "  -> no overlaps; returning empty" << std::endl;
             }
+            return no_words("", "");
         }
+    }
 
-        if (cand_idxs.empty()) {
-            if (return_invalid_words) {
-                if (print_details) {
-                    std::cout << "  -> no overlaps; returning original: " << query_display << "  " << std::endl;
-                }
-                suggestions[query_display] = {query_display, "", ""};
-                final_scores[query_display] = {0.0, 0.0, 0.0};
-                output.push_back(query_display + "  ");
-                continue;
-            } else {
-                if (print_details) {
-                    std::cout << "  -> no overlaps; returning empty" << std::endl;
-                }
-                suggestions[query_display] = {"", "", ""};
-                final_scores[query_display] = {0.0, 0.0, 0.0};
-                output.push_back("");
-                continue;
-            }
+    // d) Score every candidate without the keyboard, then rescore only the top-`shortlist` with it
+    std::vector<ScoredWord> words = score_candidates(ix, query, qb_count, cand_idxs, 0.0, scratch);
+
+    auto by_base = [](const ScoredWord& a, const ScoredWord& b) {
+        return a.base > b.base || (a.base == b.base && a.idx < b.idx); // Desc
+    };
+    size_t shortlist_size = SHORTLIST_PER_K * k;
+    if (words.size() > shortlist_size) {
+        std::nth_element(words.begin(), words.begin() + shortlist_size, words.end(), by_base);
+        words.resize(shortlist_size);
+    }
+
+    score_keyboard(ix, query, words, use_keyboard, 0.0, false, scratch);
+
+    // e) Pop the best off a heap until k different suggestions are out
+    auto by_score = [](const ScoredWord& a, const ScoredWord& b) {
+        return a.score < b.score || (a.score == b.score && a.idx > b.idx); // Max-heap on score, then lower idx
+    };
+    std::make_heap(words.begin(), words.end(), by_score);
+
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> top;
+    std::vector<double> top_scores;
+
+    for (auto end = words.end(); end != words.begin() && top.size() < k; --end) {
+        std::pop_heap(words.begin(), end, by_score);
+        const ScoredWord& word = *(end - 1);
+
+        std::string suggestion(ix.display(word.idx));
+
+        if (seen.find(suggestion) == seen.end()) {
+            seen.insert(suggestion);
+            top.push_back(suggestion);
+            top_scores.push_back(word.score);
         }
+    }
 
-        // d) Compute Jaccard & Zipf score R for each candidate
-        std::unordered_map<int, double> J; // Jaccards
-        std::unordered_map<int, double> R; // Ranks
+    while (top.size() < k) {
+        top.push_back("");
+        top_scores.push_back(0.0);
+    }
 
-        for (auto& [idx, inter] : cand_idxs) {
-            int word_ones = 0;
-            for (uint64_t block : word_bits[idx]) {
-                word_ones += popcount64(block);
-            }
+    std::string line = top[0];
+    for (int i = 1; i < k; ++i) {
+        line += " " + top[i];
+    }
 
-            double uni = qb_count + word_ones - inter;
-            J[idx] = (uni != 0 ? (double)(inter) / uni : 0.0);
-            R[idx] = 1.0 / ((idx + 1) / BUCKET_SIZE + 1); // same Zipf normalization as before
+    if (print_details) {
+        details << std::setw(12) << std::right << query << " -> top " << k << ": " << top[0];
+        for (int i = 1; i < k; ++i) {
+            details << ", " << top[i];
         }
+        details << std::endl;
+        details << std::string(30, '-') << std::endl;
+    }
+
+    return answer(top, top_scores, line);
+}
 
-        // e) Sweep tau to pick top 3
-        // Build Jaccard + Zipf score for all candidates
-        std::vector<std::pair<double, int>> scored;
-        for (auto& [idx, jval] : J) {
-            double length_penalty = 1.0 - std::pow((double)(std::abs((int)(word_dict[idx].length()) - (int)(query.length()))) / (double)(query.length()), 2);
-            double base_score = (J[idx] + alpha * R[idx]) * length_penalty;
-            scored.push_back(std::pair{base_score, idx});
+std::vector<std::pair<int, int>> Autocorrector::find_candidates(const DictionaryIndex& ix, const std::vector<int>& q_ids, const std::vector<uint64_t>& qb, QueryScratch& scratch, double min_jaccard) const {
+    std::vector<int>& posting_counts = scratch.posting_counts;
+    int qb_count = q_ids.size();
+
+    // J <= min(|Q|, |W|) / max(|Q|, |W|), so |W| must lie in [tau * |Q|, |Q| / tau] to ever reach J >= tau
+    bool prune = min_jaccard > 0.0;
+    int min_ones = 1, max_ones = INT32_MAX;
+    if (prune) {
+        min_ones = std::max(1, (int)std::ceil(min_jaccard * qb_count - 1e-9));
+        max_ones = (int)std::floor(qb_count / min_jaccard + 1e-9);
+    }
+    auto size_ok = [&](int idx) {
+        return ix.word_qgram_counts[idx] >= min_ones && ix.word_qgram_counts[idx] <= max_ones;
+    };
+    auto jaccard_ok = [&](int idx, int inter) {
+        return (double)(inter) / (double)(qb_count + ix.word_qgram_counts[idx] - inter) >= min_jaccard;
+    };
+
+    scratch.stats.words += ix.word_lengths.size() - ix.removed_count;
+
+    // Postings: merge the lists of the query's qgrams, only touching words that share one
+    std::vector<int> order;
+    int prefix_len = 0;
+    if (use_postings) {
+        if (posting_counts.size() < ix.word_lengths.size()) {
+            posting_counts.resize(ix.word_lengths.size(), 0); // Here, so scratch that never merges postings stays empty
         }
 
-        // Take only the top-`shortlist` by base_score
-        std::sort(scored.begin(), scored.end(),
-            [](auto const& a, auto const& b){
-                return a.first > b.first; // Desc
-            }
-        );
+        order = q_ids;
+        prefix_len = order.size();
 
-        size_t shortlist_size = std::min(scored.size(), size_t(30));
-        std::vector<std::pair<double,int>> shortlist(scored.begin(), scored.begin() + shortlist_size);
+        if (prune) {
+            // Prefix filter: J >= tau needs an overlap of at least ceil(tau * |Q|) qgrams, so every such word
+            // shows up in the |Q| - ceil(tau * |Q|) + 1 rarest postings. Later lists only add to started words.
+            std::sort(order.begin(), order.end(), [&](int x, int y) {
+                return ix.postings(x).second - ix.postings(x).first < ix.postings(y).second - ix.postings(y).first;
+            });
+            prefix_len = std::max(0, qb_count - min_ones + 1);
+        }
+    }
 
-        // If use_keyboard, recompute with keyboard distance
-        std::vector<std::pair<double, int>> final;
+    // Rows: stream over the flat bit matrix with one aligned row per word, or the packed sorted idxs
+    std::vector<uint16_t> q_sorted;
+    if (!use_postings && ix.sparse_rows) {
+        q_sorted.assign(q_ids.begin(), q_ids.end());
+        std::sort(q_sorted.begin(), q_sorted.end());
+    }
 
-        for (auto& [base_score, idx] : shortlist) {
-            double score;
-            if (use_keyboard) {
-                double norm_dist = 1.0 / (1.0 + word_dist(query, word_dict[idx]));
-                score = base_score + beta * norm_dist + (query == word_dict[idx] ? 1 : 0);
-            } else {
-                score = base_score + (query == word_dict[idx] ? 1 : 0);
+    // Words [lo, hi) only, so a split query's chunks never share a counter
+    auto scan = [&](int lo, int hi, std::vector<std::pair<int, int>>& cand_idxs, PruneStats& stats) {
+        if (use_postings) {
+            std::vector<int> touched;
+            for (int k = 0; k < order.size(); ++k) {
+                auto [begin, end] = ix.postings(order[k]);
+                const int* first = (lo == 0 ? begin : std::lower_bound(begin, end, lo));
+
+                if (k < prefix_len) {
+                    for (const int* it = first; it != end && *it < hi; ++it) {
+                        int idx = *it;
+                        int& count = posting_counts[idx];
+                        if (count > 0) {
+                            ++count;
+                        } else if (count == 0) {
+                            touched.push_back(idx);
+                            if (size_ok(idx)) {
+                                count = 1;
+                            } else {
+                                count = -1; // Size pruned, never revisit
+                                ++stats.size_pruned;
+                            }
+                        }
+                    }
+                } else {
+                    for (const int* it = first; it != end && *it < hi; ++it) {
+                        if (posting_counts[*it] > 0) {
+                            ++posting_counts[*it];
+                        } else {
+                            ++stats.prefix_skipped;
+                        }
+                    }
+                }
             }
+            std::sort(touched.begin(), touched.end()); // Same order as the bitset scan
 
-            final.push_back(std::pair{score, idx});
-        }
+            cand_idxs.reserve(touched.size());
+            for (int idx : touched) {
+                int inter = posting_counts[idx];
+                posting_counts[idx] = 0;
+
+                if (inter <= 0 || ix.is_removed(idx)) {
+                    continue;
+                }
 
-        // Sort and return top 3
-        std::sort(final.begin(), final.end(),
-            [](auto const& a, auto const& b){
-                return a.first > b.first; // Desc
+                if (prune && !jaccard_ok(idx, inter)) {
+                    ++stats.jaccard_pruned;
+                    continue;
+                }
+
+                cand_idxs.emplace_back(idx, inter);
             }
-        );
+        } else {
+            // 64 words at a time: the live mask is the block's tombstones ANDed out, then only its set bits are visited
+            for (int blk_lo = lo & ~63; blk_lo < hi; blk_lo += 64) {
+                uint64_t live = (ix.removed_count > 0 ? ~ix.tombstones[blk_lo >> 6] : ~0ULL);
+                if (blk_lo < lo) {
+                    live &= ~0ULL << (lo - blk_lo);
+                }
+                if (hi - blk_lo < 64) {
+                    live &= (1ULL << (hi - blk_lo)) - 1;
+                }
 
-        std::unordered_set<std::string> seen;
-        std::vector<std::string> top3;
-        std::vector<double> top3_scores;
+                for (; live; live &= live - 1) {
+                    int idx = blk_lo + lowest_bit(live);
 
-        for (auto& [score, idx] : final) {
-            std::string suggestion = display_map[word_dict[idx]];
+                    if (prune && !size_ok(idx)) {
+                        ++stats.size_pruned;
+                        continue;
+                    }
 
-            if (seen.find(suggestion) == seen.end()) {
-                seen.insert(suggestion);
-                top3.push_back(suggestion);
-                top3_scores.push_back(score);
+                    int inter;
+                    if (ix.sparse_rows) {
+                        inter = intersect_count(q_sorted.data(), q_sorted.size(), ix.row_ids.data() + ix.row_offsets[idx], ix.row_offsets[idx + 1] - ix.row_offsets[idx]);
+                    } else {
+                        inter = and_popcount_words(ix.word_bits.data() + (size_t)(idx) * ix.row_stride, qb.data(), ix.row_stride);
+                    }
 
-                if (top3.size() == 3) {
-                    break;
+                    if (inter > 0) {
+                        if (prune && !jaccard_ok(idx, inter)) {
+                            ++stats.jaccard_pruned;
+                            continue;
+                        }
+                        cand_idxs.emplace_back(idx, inter);
+                    }
                 }
             }
         }
 
-        while (top3.size() < 3) {
-            top3.push_back("");
-            top3_scores.push_back(0.0);
-        }
+        stats.scored += cand_idxs.size();
+    };
 
-        if (print_details) {
-            std::cout << std::setw(12) << std::right << query << " -> top 3: " << top3[0] << ", " << top3[1] << ", " << top3[2] << std::endl;
-            std::cout << std::string(30, '-') << std::endl;
-        }
+    int rows = ix.word_lengths.size();
+    int chunks = chunk_count(rows, scratch);
 
-        suggestions[query_display] = top3;
-        final_scores[query_display] = top3_scores;
-        output.push_back(top3[0] + " " + top3[1] + " " + top3[2]);
+    if (chunks == 1) {
+        std::vector<std::pair<int, int>> cand_idxs;
+        scan(0, rows, cand_idxs, scratch.stats);
+        return cand_idxs;
     }
 
-    // 4) Write out
-    t3 = std::chrono::steady_clock::now();
+    // Chunks are in word order, so concatenating them gives exactly the serial candidates
+    std::vector<std::vector<std::pair<int, int>>> parts(chunks);
+    std::vector<PruneStats> part_stats(chunks);
+    run_chunks(chunks, rows, [&](int c, size_t lo, size_t hi) {
+        scan(lo, hi, parts[c], part_stats[c]);
+    });
+
+    size_t total = 0;
+    for (int c = 0; c < chunks; ++c) {
+        total += parts[c].size();
+        merge_stats(scratch.stats, part_stats[c]);
+    }
 
-    if (output_file != std::filesystem::path("None")) {
-        std::ofstream out(output_file);
+    std::vector<std::pair<int, int>> cand_idxs;
+    cand_idxs.reserve(total);
+    for (auto& part : parts) {
+        cand_idxs.insert(cand_idxs.end(), part.begin(), part.end());
+    }
+    return cand_idxs;
+}
 
-        if (!out) {
-            throw std::runtime_error("Failed to open output file: " + output_file.string());
-        }
+double Autocorrector::jaccard(const DictionaryIndex& ix, int qb_count, int idx, int inter) const {
+    double uni = qb_count + ix.word_qgram_counts[idx] - inter;
+    return (uni != 0 ? (double)(inter) / uni : 0.0);
+}
 
-        for (int i = 0; i < output.size(); ++i) {
-            out << output[i];
-            if (i + 1 < output.size()) {
-                out << "\n";
+std::vector<ScoredWord> Autocorrector::score_candidates(const DictionaryIndex& ix, const std::string& query, int qb_count, const std::vector<std::pair<int, int>>& cand_idxs, double min_jaccard, QueryScratch& scratch) const {
+    int chunks = chunk_count(cand_idxs.size(), scratch);
+    std::vector<std::vector<ScoredWord>> parts(chunks);
+
+    run_chunks(chunks, cand_idxs.size(), [&](int c, size_t lo, size_t hi) {
+        std::vector<ScoredWord>& part = parts[c];
+        part.reserve(hi - lo);
+
+        for (size_t k = lo; k < hi; ++k) {
+            auto [idx, inter] = cand_idxs[k];
+            double jval = jaccard(ix, qb_count, idx, inter);
+            if (jval < min_jaccard) {
+                continue;
             }
-        }
-    }
 
-    // 5) Output time elapsed
-    end_total = std::chrono::steady_clock::now();
+            int tau_rank = 0;
+            while (tau_rank + 1 < TAU_CANDS.size() && jval < TAU_CANDS[tau_rank]) {
+                ++tau_rank;
+            }
 
-    if (print_times) {
-        double dur_build_sketches = std::chrono::duration<double>(t1 - t0).count();
-        double dur_build_bitvectors = std::chrono::duration<double>(t2 - t1).count();
-        double dur_query_processing = std::chrono::duration<double>(t3 - t2).count();
-        double dur_total = std::chrono::duration<double>(end_total - t0).count();
+            double zipf = 1.0 / ((idx + 1) / ix.BUCKET_SIZE + 1); // Same Zipf normalization as before
+            double length_penalty = 1.0 - std::pow((double)(std::abs(ix.word_lengths[idx] - (int)(query.length()))) / (double)(query.length()), 2);
+            double bonus = (query == ix.word(idx) ? 1 : 0);
 
-        std::cout << std::fixed << std::setprecision(3);
-        std::cout << "Build sketches:    " << dur_build_sketches   << "s\n";
-        std::cout << "Build bit-vectors: " << dur_build_bitvectors << "s\n";
-        std::cout << "Query processing:  " << dur_query_processing << "s\n";
-        std::cout << "Total autocorrect: " << dur_total            << "s\n";
+            part.push_back(ScoredWord{idx, jval, (jval + alpha * zipf) * length_penalty, bonus, -INFINITY, tau_rank});
+        }
+    });
+
+    if (chunks == 1) {
+        return std::move(parts[0]);
     }
 
-    // Return
-    return (Results){suggestions, final_scores};
+    std::vector<ScoredWord> words;
+    for (auto& part : parts) {
+        words.insert(words.end(), part.begin(), part.end());
+    }
+    return words;
 }
 
-// ======== Autocorrector CLASS: PRIVATE ======== //
-double Autocorrector::key_dist(char& a, char& b) {
-    int xa = 0, ya = 0, xb = 0, yb = 0;
-
-    auto it_a = KEY_POS.find(a);
-    if (it_a != KEY_POS.end()) {
-        xa = it_a->second.x;
-        ya = it_a->second.y;
+void Autocorrector::score_keyboard(const DictionaryIndex& ix, const std::string& query, std::vector<ScoredWord>& words, bool use_keyboard, double no_keyboard_term, bool best_only, QueryScratch& scratch) const {
+    if (!use_keyboard) {
+        for (ScoredWord& word : words) {
+            word.score = word.base + no_keyboard_term + word.bonus;
+        }
+        return;
     }
 
-    auto it_b = KEY_POS.find(b);
-    if (it_b != KEY_POS.end()) {
-        xb = it_b->second.x;
-        yb = it_b->second.y;
+    if (!best_only) { // Every distance is needed, run them 8 to a DP
+        std::vector<int> idxs;
+        idxs.reserve(words.size());
+        for (const ScoredWord& word : words) {
+            idxs.push_back(word.idx);
+        }
+
+        std::vector<double> dists(words.size());
+        word_dists(ix, query, idxs, dists.data());
+
+        for (int k = 0; k < words.size(); ++k) {
+            words[k].score = words[k].base + beta * (1.0 / (1.0 + dists[k])) + words[k].bonus;
+        }
+        return;
     }
 
-    int dx = xa - xb;
-    int dy = ya - yb;
+    // Only the best score is wanted, so visit words by their upper bound (distance >= length difference) and
+    // band the DP to the largest distance that still reaches the best so far. Words left at -inf score strictly
+    // below the best, so they can neither win nor tie.
+    int chunks = chunk_count(words.size(), scratch);
+    std::vector<PruneStats> chunk_stats(chunks);
+
+    run_chunks(chunks, words.size(), [&](int c, size_t lo, size_t hi) {
+        std::vector<double> bounds(hi - lo);
+        std::vector<size_t> order(hi - lo);
+        for (size_t k = lo; k < hi; ++k) {
+            const ScoredWord& word = words[k];
+            bounds[k - lo] = word.base + beta / (1.0 + std::abs(ix.word_lengths[word.idx] - (int)(query.length()))) + word.bonus;
+            order[k - lo] = k;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+            return bounds[x - lo] > bounds[y - lo] || (bounds[x - lo] == bounds[y - lo] && x < y);
+        });
+
+        std::vector<uint8_t> sa = to_key_slots(query), sb;
+        PruneStats& cs = chunk_stats[c];
+        double best = -INFINITY;
 
-    return std::sqrt(dx * dx + dy * dy);
+        for (size_t k : order) {
+            ScoredWord& word = words[k];
+            long long full = (long long)(query.length()) * ix.word_lengths[word.idx];
+
+            if (bounds[k - lo] < best - SCORE_EPS) { // Sorted, so neither can the rest
+                cs.dp_cells_saved += full;
+                continue;
+            }
+
+            // beta / (1 + d) >= best - base - bonus  <=>  d <= beta / (best - base - bonus) - 1
+            double room = best - SCORE_EPS - (word.base + word.bonus);
+            double cutoff = (room > 0 ? beta / room - 1.0 : INFINITY);
+            cutoff += SCORE_EPS * (1.0 + std::abs(cutoff));
+
+            long long cells = 0;
+            sb = to_key_slots(ix.word(word.idx));
+            double dist = key_edit_distance_bounded(sa.data(), sa.size(), sb.data(), sb.size(), key_dists.data(), key_slots, cutoff, &cells);
+            cs.dp_cells += cells;
+            cs.dp_cells_saved += full - cells;
+
+            if (dist > cutoff) {
+                continue;
+            }
+
+            word.score = word.base + beta * (1.0 / (1.0 + dist)) + word.bonus;
+            best = std::max(best, word.score);
+        }
+    });
+
+    for (PruneStats& cs : chunk_stats) {
+        merge_stats(scratch.stats, cs);
+    }
 }
 
-double Autocorrector::word_dist(const std::string& a, const std::string& b) {
-    int na = a.length();
-    int nb = b.length();
+int Autocorrector::chunk_count(size_t n, const QueryScratch& scratch) const {
+    if (!scratch.split || !pool) {
+        return 1;
+    }
+    return (int)std::max<size_t>(1, std::min(n / SPLIT_MIN_CHUNK, (size_t)(pool->size()) * 4)); // A few chunks per thread for stealing
+}
 
-    std::vector<double> prev(nb + 1), curr(nb + 1);
+void Autocorrector::run_chunks(int chunks, size_t n, const std::function<void(int, size_t, size_t)>& fn) const {
+    auto run = [&](size_t c, int) {
+        fn(c, c * n / chunks, (c + 1) * n / chunks);
+    };
 
-    for (int j = 0; j <= nb; ++j) {
-        prev[j] = double(j);
+    if (chunks > 1 && pool) {
+        pool->parallel_for(chunks, run);
+    } else {
+        for (int c = 0; c < chunks; ++c) {
+            run(c, 0);
+        }
     }
+}
 
-    for (int i = 1; i <= na; ++i) {
-        curr[0] = double(i);
-        char ai = std::tolower(a[i - 1]);
-        for (int j = 1; j <= nb; ++j) {
-            char bj = std::tolower(b[j - 1]);
-            double cost_sub = prev[j - 1] + key_dist(ai, bj);
-            double cost_del = prev[j] + 1.0;
-            double cost_ins = curr[j - 1]+ 1.0;
-            curr[j] = std::min({cost_sub, cost_del, cost_ins});
+void Autocorrector::word_dists(const DictionaryIndex& ix, const std::string& a, const std::vector<int>& idxs, double* out) const {
+    std::vector<uint8_t> sa = to_key_slots(a);
+
+    // All candidates' slots back to back
+    std::vector<uint8_t> slots;
+    std::vector<size_t> starts, lengths;
+    starts.reserve(idxs.size());
+    lengths.reserve(idxs.size());
+    for (int idx : idxs) {
+        starts.push_back(slots.size());
+        std::string_view w = ix.word(idx);
+        lengths.push_back(w.length());
+        for (char c : w) {
+            slots.push_back(key_slot[(unsigned char)(c)]);
         }
-        std::swap(prev, curr);
     }
-    return prev[nb];
+
+    std::vector<const uint8_t*> words(idxs.size());
+    for (int k = 0; k < idxs.size(); ++k) {
+        words[k] = slots.data() + starts[k];
+    }
+
+    key_edit_distance_batch(sa.data(), sa.size(), words.data(), lengths.data(), idxs.size(), key_dists.data(), key_slots, out);
+}
+
+std::vector<uint8_t> Autocorrector::to_key_slots(std::string_view word) const {
+    std::vector<uint8_t> slots(word.length());
+    for (int i = 0; i < word.length(); ++i) {
+        slots[i] = key_slot[(unsigned char)(word[i])];
+    }
+    return slots;
 }
 
-bool Autocorrector::is_valid(std::string& word) {
+bool Autocorrector::is_valid(const std::string& word) const {
     return ::is_valid(word, letters);
 }
 
@@ -0,0 +1,396 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: DictionaryIndex.cpp                *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#include "../include/FQ-HLL/DictionaryIndex.h"
+#include <algorithm>
+#include <cmath>
+
+// ~~~~~~~~ VARIABLES ~~~~~~~~ //
+static const int SPARSE_MIN_QGRAMS = 2048; // "auto" row format goes sparse once dense rows pass 256 bytes
+
+// ======== DictionaryIndex CLASS: PUBLIC ======== //
+DictionaryIndex::DictionaryIndex(std::vector<std::string> words, std::unordered_map<std::string, std::string> display, int _b, const std::string& _row_format, int _register_bits) : word_dict(std::move(words)), display_map(std::move(display)), b(_b), register_bits(_register_bits), row_format(_row_format) {
+    word_set.reserve(word_dict.size());
+    for (auto& w : word_dict) {
+        word_set.insert(w);
+    }
+
+    rebuild();
+}
+
+void DictionaryIndex::rebuild() {
+    unmap();
+    auto t0 = std::chrono::steady_clock::now();
+
+    q = 2;
+    cfg = SketchConfig{};
+    cfg.b = b;
+    cfg.register_bits = register_bits;
+
+    // Qgram idxs in order of first appearance, so later adds only ever append idxs
+    all_qgrams.edit().clear();
+    qgram_idx.edit().assign(QGRAM_CODES, -1);
+    for (int i = 0; i < word_dict.size(); ++i) {
+        for_each_qgram_code(word_dict[i], false, [&](QgramCode code) {
+            add_qgram(code);
+        });
+    }
+
+    TOTAL_QGRAMS = all_qgrams.size();
+
+    // Build FQ-HLL per q-gram
+    build_sketches();
+
+    // Precompute dict-word q gram sets for Jaccard
+    auto t1 = std::chrono::steady_clock::now();
+    sketch_seconds = std::chrono::duration<double>(t1 - t0).count();
+
+    // One row per word, plus postings and per-word metadata
+    sparse_rows = wants_sparse_rows(TOTAL_QGRAMS);
+
+    word_bits.edit().clear();
+    row_stride = 0;
+    row_ids.edit().clear();
+    row_offsets.edit().assign(1, 0);
+
+    if (sparse_rows) {
+        row_offsets.edit().reserve(word_dict.size() + 1);
+    } else {
+        set_row_stride((TOTAL_QGRAMS + 63) / 64);
+        word_bits.edit().reserve(word_dict.size() * row_stride);
+    }
+
+    qgram_postings.assign(TOTAL_QGRAMS, std::vector<int>());
+    word_qgram_counts.edit().clear();
+    word_qgram_counts.edit().reserve(word_dict.size());
+    word_lengths.edit().clear();
+    word_lengths.edit().reserve(word_dict.size());
+
+    for (size_t i = 0; i < word_dict.size(); ++i) {
+        append_word_row(word_dict[i]);
+    }
+
+    row_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+}
+
+std::vector<std::string> DictionaryIndex::add(const std::vector<std::string>& words, const std::unordered_map<std::string, std::string>& displays) {
+    unmap();
+
+    std::vector<std::string> added;
+    std::vector<std::string> remove_added;
+
+    for (auto& word : words) {
+        if (word_set.find(word) == word_set.end()) {
+            added.push_back(word);
+        } else {
+            remove_added.push_back(word);
+        }
+    }
+
+    if (removed_count > 0 && !remove_added.empty()) {
+        set_removed(std::unordered_set<std::string>(remove_added.begin(), remove_added.end()), false);
+    }
+
+    if (added.empty()) {
+        return remove_added;
+    }
+
+    // New qgrams take the next idxs, existing idxs (and so every existing row, posting and sketch) never move
+    for (auto& w : added) {
+        for_each_qgram_code(w, false, [&](QgramCode code) {
+            add_qgram(code);
+        });
+    }
+    TOTAL_QGRAMS = all_qgrams.size();
+
+    // Only an "auto" format switching over lays the rows out again
+    if (wants_sparse_rows(TOTAL_QGRAMS) != sparse_rows) {
+        for (auto& add : added) {
+            word_dict.push_back(add);
+            word_set.insert(add);
+            display_map[add] = displays.at(add);
+        }
+
+        rebuild();
+
+        for (std::string& str : remove_added) {
+            added.push_back(str);
+        }
+
+        return added;
+    }
+
+    qgram_postings.resize(TOTAL_QGRAMS);
+    if (!sparse_rows) {
+        set_row_stride((TOTAL_QGRAMS + 63) / 64); // Only widens once the qgrams outgrow the row's cache lines
+    }
+
+    int old_exp = std::log2(NUM_BUCKETS);
+    int new_exp = std::ceil(std::log2(word_dict.size() + added.size()) / 2);
+    int base = word_dict.size();
+
+    // Append one row per new word
+    for (auto& w : added) {
+        word_dict.push_back(w);
+        word_set.insert(w);
+        display_map[w] = displays.at(w);
+        append_word_row(w);
+    }
+
+    // 1) Exponent bumps move every word's Zipf shift, so only the sketches are rebuilt
+    if (new_exp != old_exp) {
+        build_sketches();
+    } else {
+        // 2) Otherwise true O(1) per-word work:
+        // Recomupte NUM_BUCKETS (BUCKET_SIZE stays frozen)
+        WORD_COUNT = word_dict.size();
+        NUM_BUCKETS = std::ceil(WORD_COUNT / BUCKET_SIZE);
+        qgram_sketches.resize(TOTAL_QGRAMS, HyperLogLog(cfg));
+
+        for (int i = 0; i < added.size(); ++i) {
+            int bucket_idx = (base + i + 1) / BUCKET_SIZE + 1;
+            int shift = std::min((int)(std::floor(std::log2(NUM_BUCKETS / bucket_idx))) * 4, 64);
+
+            for_each_qgram_code(added[i], false, [&](QgramCode code) {
+                qgram_sketches[qgram_idx[code]].shifted_insert(qgram_code_to_string(code) + "_" + added[i], shift);
+            });
+        }
+    }
+
+    for (std::string& str : remove_added) {
+        added.push_back(str);
+    }
+
+    return added;
+}
+
+std::vector<std::string> DictionaryIndex::remove(const std::vector<std::string>& words) {
+    unmap();
+
+    std::vector<std::string> removed;
+    std::unordered_set<std::string> marked;
+
+    for (auto& word : words) {
+        if (word_set.find(word) != word_set.end()) {
+            marked.insert(word);
+            removed.push_back(word);
+        }
+    }
+
+    if (!marked.empty()) {
+        set_removed(marked, true);
+    }
+
+    // If too many removed, full rebuild
+    size_t og_size = word_dict.size();
+    if (removed_count >= og_size * compact_threshold) {
+        size_t kept = 0;
+        for (size_t i = 0; i < og_size; ++i) {
+            if (is_removed(i)) {
+                display_map.erase(word_dict[i]);
+                word_set.erase(word_dict[i]);
+            } else if (kept++ != i) {
+                word_dict[kept - 1] = std::move(word_dict[i]);
+            }
+        }
+        word_dict.resize(kept);
+
+        tombstones.edit().clear();
+        removed_count = 0;
+        rebuild();
+    }
+
+    return removed;
+}
+
+void DictionaryIndex::unmap() {
+    if (!snapshot) {
+        return;
+    }
+
+    int words = word_lengths.size();
+    word_dict.clear();
+    word_dict.reserve(words);
+    display_map.clear();
+    word_set.clear();
+    for (int i = 0; i < words; ++i) {
+        word_dict.emplace_back(word(i));
+        display_map[word_dict[i]] = std::string(display(i));
+        word_set.insert(word_dict[i]);
+    }
+
+    qgram_postings.assign(TOTAL_QGRAMS, std::vector<int>());
+    qgram_sketches.clear();
+    qgram_sketches.reserve(TOTAL_QGRAMS);
+    for (int g = 0; g < TOTAL_QGRAMS; ++g) {
+        auto [first, last] = postings(g);
+        qgram_postings[g].assign(first, last);
+        qgram_sketches.emplace_back(cfg, sketch_registers.data() + ((size_t)(g) << b));
+    }
+
+    all_qgrams.edit();
+    qgram_idx.edit();
+    word_bits.edit();
+    row_ids.edit();
+    row_offsets.edit();
+    word_qgram_counts.edit();
+    word_lengths.edit();
+    tombstones.edit();
+
+    word_offsets = Column<uint64_t>();
+    word_chars = Column<char>();
+    display_offsets = Column<uint64_t>();
+    display_chars = Column<char>();
+    posting_offsets = Column<uint32_t>();
+    posting_words = Column<int>();
+    sketch_registers = Column<uint8_t>();
+    snapshot.reset();
+}
+
+int DictionaryIndex::size() const {
+    return word_lengths.size();
+}
+
+std::string_view DictionaryIndex::word(int idx) const {
+    if (snapshot) {
+        return std::string_view(word_chars.data() + word_offsets[idx], word_offsets[idx + 1] - word_offsets[idx]);
+    }
+    return word_dict[idx];
+}
+
+std::string_view DictionaryIndex::display(int idx) const {
+    if (snapshot) {
+        return std::string_view(display_chars.data() + display_offsets[idx], display_offsets[idx + 1] - display_offsets[idx]);
+    }
+
+    auto it = display_map.find(word_dict[idx]);
+    return (it != display_map.end() ? std::string_view(it->second) : std::string_view(word_dict[idx]));
+}
+
+std::pair<const int*, const int*> DictionaryIndex::postings(int qgram) const {
+    if (snapshot) {
+        return {posting_words.data() + posting_offsets[qgram], posting_words.data() + posting_offsets[qgram + 1]};
+    }
+
+    const std::vector<int>& list = qgram_postings[qgram];
+    return {list.data(), list.data() + list.size()};
+}
+
+double DictionaryIndex::qgram_estimate(int qgram) const {
+    if (snapshot) {
+        return HyperLogLog::estimate(cfg, sketch_registers.data() + ((size_t)(qgram) << b));
+    }
+    return qgram_sketches[qgram].estimate();
+}
+
+bool DictionaryIndex::is_removed(int idx) const {
+    return removed_count > 0 && (tombstones[idx >> 6] >> (idx & 63)) & 1;
+}
+
+// ======== DictionaryIndex CLASS: PRIVATE ======== //
+int DictionaryIndex::add_qgram(QgramCode code) {
+    if (qgram_idx[code] < 0) {
+        qgram_idx.edit()[code] = all_qgrams.size();
+        all_qgrams.edit().push_back(code);
+    }
+    return qgram_idx[code];
+}
+
+bool DictionaryIndex::wants_sparse_rows(int total_qgrams) const {
+    // Sparse rows store 16-bit idxs, so need <= 65536 qgrams
+    return total_qgrams <= 65536 && (row_format == "sparse" || (row_format == "auto" && total_qgrams >= SPARSE_MIN_QGRAMS));
+}
+
+void DictionaryIndex::build_sketches() {
+    WORD_COUNT = word_dict.size();
+    NUM_BUCKETS = 1 << ((int)(std::ceil(std::log2((double)(WORD_COUNT)) / 2.0)));
+    BUCKET_SIZE = (int)(std::ceil(WORD_COUNT / NUM_BUCKETS));
+
+    qgram_sketches.assign(TOTAL_QGRAMS, HyperLogLog(cfg));
+
+    for (int i = 0; i < word_dict.size(); ++i) {
+        // For fuzzy-HLL: shift by Zipf bucket, more shift = more common
+        int bucket_idx = (int)std::min(NUM_BUCKETS, (int)((i + 1) / BUCKET_SIZE) + 1);
+        int shift = (int)std::min((int)(std::floor(std::log2((double)(NUM_BUCKETS) / (double)(bucket_idx)))) * 4, 64);
+
+        for_each_qgram_code(word_dict[i], false, [&](QgramCode code) {
+            qgram_sketches[qgram_idx[code]].shifted_insert(qgram_code_to_string(code) + "_" + word_dict[i], shift);
+        });
+    }
+
+    // Rare grams stay sparse, without the slack their lists grew with
+    for (HyperLogLog& sketch : qgram_sketches) {
+        sketch.compact();
+    }
+}
+
+void DictionaryIndex::set_row_stride(int blocks) {
+    int stride = std::max(8, (blocks + 7) / 8 * 8);
+    if (stride <= row_stride) {
+        return;
+    }
+
+    // Re-lay rows at the wider stride, new blocks are zero
+    int rows = row_stride ? word_bits.size() / row_stride : 0;
+    BitMatrix wider((size_t)(rows) * stride, 0ULL);
+    for (int r = 0; r < rows; ++r) {
+        std::copy(word_bits.begin() + (size_t)(r) * row_stride, word_bits.begin() + (size_t)(r + 1) * row_stride, wider.begin() + (size_t)(r) * stride);
+    }
+
+    word_bits.edit() = std::move(wider);
+    row_stride = stride;
+}
+
+void DictionaryIndex::append_word_row(std::string& word) {
+    int word_idx = word_lengths.size();
+    std::vector<int> ids;
+
+    for_each_qgram_code(word, false, [&](QgramCode code) {
+        if (qgram_idx[code] >= 0) {
+            ids.push_back(qgram_idx[code]);
+        }
+    });
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    if (sparse_rows) {
+        row_ids.edit().insert(row_ids.edit().end(), ids.begin(), ids.end());
+        row_offsets.edit().push_back(row_ids.size());
+    } else {
+        BitMatrix& bits = word_bits.edit();
+        bits.resize(bits.size() + row_stride, 0ULL);
+        uint64_t* row = bits.data() + (size_t)(word_idx) * row_stride;
+
+        for (int bit : ids) {
+            size_t blk = bit >> 6; // Which uint64_t
+            size_t off = bit & 0x3F;  // Which bit in that word
+            row[blk] |= (1ULL << off);
+        }
+    }
+
+    for (int bit : ids) {
+        qgram_postings[bit].push_back(word_idx);
+    }
+
+    word_qgram_counts.edit().push_back(ids.size());
+    word_lengths.edit().push_back(word.length());
+    if ((size_t)(word_idx >> 6) >= tombstones.size()) {
+        tombstones.edit().push_back(0ULL);
+    }
+}
+
+void DictionaryIndex::set_removed(const std::unordered_set<std::string>& words, bool removed) {
+    // One pass, so every copy of a word the dictionary lists twice follows it
+    std::vector<uint64_t>& dead = tombstones.edit();
+    for (int i = 0; i < word_lengths.size(); ++i) {
+        if (is_removed(i) != removed && words.count(word_dict[i])) {
+            dead[i >> 6] ^= 1ULL << (i & 63);
+            removed_count += (removed ? 1 : -1);
+        }
+    }
+}
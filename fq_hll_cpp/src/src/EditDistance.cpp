@@ -0,0 +1,211 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: EditDistance.cpp                   *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#include "../include/FQ-HLL/EditDistance.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define FQHLL_X86_DISPATCH 1
+    #include <immintrin.h>
+#endif
+
+// ~~~~~~~~ VARIABLES ~~~~~~~~ //
+static const size_t STACK_ROW = 64; // Rows up to this length stay off the heap
+
+// ======== SCALAR ======== //
+double key_edit_distance(const uint8_t* a, size_t na, const uint8_t* b, size_t nb, const double* sub, int slots) {
+    double stack_rows[2 * (STACK_ROW + 1)];
+    std::vector<double> heap_rows;
+    double* prev = stack_rows;
+    if (nb > STACK_ROW) {
+        heap_rows.resize(2 * (nb + 1));
+        prev = heap_rows.data();
+    }
+    double* curr = prev + nb + 1;
+
+    for (size_t j = 0; j <= nb; ++j) {
+        prev[j] = double(j);
+    }
+
+    for (size_t i = 1; i <= na; ++i) {
+        const double* row = sub + (size_t)(a[i - 1]) * slots;
+        curr[0] = double(i);
+        for (size_t j = 1; j <= nb; ++j) {
+            double cost_sub = prev[j - 1] + row[b[j - 1]];
+            double cost_del = prev[j] + 1.0;
+            double cost_ins = curr[j - 1] + 1.0;
+            curr[j] = std::min({cost_sub, cost_del, cost_ins});
+        }
+        std::swap(prev, curr);
+    }
+    return prev[nb];
+}
+
+double key_edit_distance_bounded(const uint8_t* a, size_t na, const uint8_t* b, size_t nb, const double* sub, int slots, double cutoff, long long* cells) {
+    size_t diff = (na > nb ? na - nb : nb - na);
+    if (!(cutoff >= (double)(diff))) { // Every indel costs 1
+        return INFINITY;
+    }
+
+    size_t band = (cutoff >= (double)(na + nb) ? na + nb : (size_t)(std::floor(cutoff)));
+    if (band >= std::max(na, nb)) { // Nothing to cut
+        if (cells) {
+            *cells += (long long)(na) * nb;
+        }
+        return key_edit_distance(a, na, b, nb, sub, slots);
+    }
+
+    double stack_rows[2 * (STACK_ROW + 1)];
+    std::vector<double> heap_rows;
+    double* prev = stack_rows;
+    if (nb > STACK_ROW) {
+        heap_rows.resize(2 * (nb + 1));
+        prev = heap_rows.data();
+    }
+    double* curr = prev + nb + 1;
+
+    // Cells outside the band stay infinite
+    std::fill(prev, prev + 2 * (nb + 1), INFINITY);
+    for (size_t j = 0; j <= std::min(nb, band); ++j) {
+        prev[j] = double(j);
+    }
+
+    long long filled = 0;
+    for (size_t i = 1; i <= na; ++i) {
+        const double* row = sub + (size_t)(a[i - 1]) * slots;
+        size_t lo = (i > band ? i - band : 1);
+        size_t hi = std::min(nb, i + band);
+
+        curr[lo - 1] = (lo == 1 && i <= band ? double(i) : INFINITY);
+        if (hi < nb) {
+            curr[hi + 1] = INFINITY;
+        }
+
+        double row_min = curr[lo - 1];
+        for (size_t j = lo; j <= hi; ++j) {
+            double cost_sub = prev[j - 1] + row[b[j - 1]];
+            double cost_del = prev[j] + 1.0;
+            double cost_ins = curr[j - 1] + 1.0;
+            curr[j] = std::min({cost_sub, cost_del, cost_ins});
+            row_min = std::min(row_min, curr[j]);
+        }
+        filled += hi - lo + 1;
+        std::swap(prev, curr);
+
+        if (row_min > cutoff) { // Rows never get cheaper
+            prev[nb] = INFINITY;
+            break;
+        }
+    }
+
+    if (cells) {
+        *cells += filled;
+    }
+    return prev[nb];
+}
+
+static void key_edit_distance_batch_portable(const uint8_t* a, size_t na, const uint8_t* const* bs, const size_t* nbs, size_t count, const double* sub, int slots, double* out) {
+    for (size_t k = 0; k < count; ++k) {
+        out[k] = key_edit_distance(a, na, bs[k], nbs[k], sub, slots);
+    }
+}
+
+#ifdef FQHLL_X86_DISPATCH
+// ======== AVX2 ======== //
+// Inter-sequence layout as in striped Smith-Waterman: cell j of the DP row holds that cell for all 8 candidates,
+// so one query row updates 8 DPs per step. Shorter candidates are padded, cells past their end never feed back.
+__attribute__((target("avx2"))) static void key_edit_distance_lanes_avx2(const uint8_t* a, size_t na, const uint8_t* const* bs, const size_t* nbs, size_t count, const double* sub, int slots, double* out) {
+    const int L = EDIT_BATCH_LANES;
+    size_t max_nb = *std::max_element(nbs, nbs + count);
+
+    // Candidate slots, column-major so each step loads one index vector
+    std::vector<int32_t> cols(max_nb * L, 0);
+    for (size_t k = 0; k < count; ++k) {
+        for (size_t j = 0; j < nbs[k]; ++j) {
+            cols[j * L + k] = bs[k][j];
+        }
+    }
+
+    std::vector<double> rows(2 * (max_nb + 1) * L);
+    double* prev = rows.data();
+    double* curr = prev + (max_nb + 1) * L;
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    for (size_t j = 0; j <= max_nb; ++j) {
+        std::fill(prev + j * L, prev + (j + 1) * L, double(j));
+    }
+
+    for (size_t i = 1; i <= na; ++i) {
+        const double* row = sub + (size_t)(a[i - 1]) * slots;
+        std::fill(curr, curr + L, double(i));
+
+        for (size_t j = 1; j <= max_nb; ++j) {
+            for (int h = 0; h < L; h += 4) {
+                __m128i idx = _mm_loadu_si128((const __m128i*)(cols.data() + (j - 1) * L + h));
+                __m256d cost = _mm256_i32gather_pd(row, idx, 8);
+                __m256d cost_sub = _mm256_add_pd(_mm256_loadu_pd(prev + (j - 1) * L + h), cost);
+                __m256d cost_del = _mm256_add_pd(_mm256_loadu_pd(prev + j * L + h), one);
+                __m256d cost_ins = _mm256_add_pd(_mm256_loadu_pd(curr + (j - 1) * L + h), one);
+                _mm256_storeu_pd(curr + j * L + h, _mm256_min_pd(_mm256_min_pd(cost_sub, cost_del), cost_ins));
+            }
+        }
+        std::swap(prev, curr);
+    }
+
+    for (size_t k = 0; k < count; ++k) {
+        out[k] = prev[nbs[k] * L + k];
+    }
+}
+
+__attribute__((target("avx2"))) static void key_edit_distance_batch_avx2(const uint8_t* a, size_t na, const uint8_t* const* bs, const size_t* nbs, size_t count, const double* sub, int slots, double* out) {
+    for (size_t k = 0; k < count; k += EDIT_BATCH_LANES) {
+        size_t n = std::min<size_t>(EDIT_BATCH_LANES, count - k);
+        if (n == 1) { // Nothing to share a DP with
+            out[k] = key_edit_distance(a, na, bs[k], nbs[k], sub, slots);
+        } else {
+            key_edit_distance_lanes_avx2(a, na, bs + k, nbs + k, n, sub, slots, out + k);
+        }
+    }
+}
+#endif
+
+// ======== DISPATCH ======== //
+struct EditDistanceKernels {
+    void (*batch)(const uint8_t*, size_t, const uint8_t* const*, const size_t*, size_t, const double*, int, double*);
+    const char* name;
+};
+
+static EditDistanceKernels pick_kernels() {
+#ifdef FQHLL_X86_DISPATCH
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        return {key_edit_distance_batch_avx2, "avx2"};
+    }
+#endif
+    return {key_edit_distance_batch_portable, "portable"};
+}
+
+static const EditDistanceKernels& kernels() {
+    static const EditDistanceKernels k = pick_kernels();
+    return k;
+}
+
+// ======== PUBLIC ======== //
+void key_edit_distance_batch(const uint8_t* a, size_t na, const uint8_t* const* bs, const size_t* nbs, size_t count, const double* sub, int slots, double* out) {
+    if (count == 0) {
+        return;
+    }
+    kernels().batch(a, na, bs, nbs, count, sub, slots, out);
+}
+
+const char* edit_distance_kernel_name() {
+    return kernels().name;
+}
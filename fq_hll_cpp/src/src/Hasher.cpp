@@ -20,18 +20,17 @@ uint64_t byteswap64(uint64_t x) {
            ((x & 0xFF00000000000000ULL) >> 56);
 }
 
-uint64_t murmur3_64(const std::string& key, uint64_t seed = 42) {
+uint64_t murmur3_64(const char* data, size_t len, uint64_t seed) {
     const uint64_t m = 0xc6a4a7935bd1e995ULL;
     const int r = 47;
 
-    size_t len = key.size();
     size_t nblocks = len / 8;
 
     uint64_t h = seed ^ (len * m);
 
     for (size_t i = 0; i < nblocks; ++i) {
         uint64_t k;
-        std::memcpy(&k, key.data() + i*8, sizeof(k));
+        std::memcpy(&k, data + i*8, sizeof(k));
 
         // Big Endian support
         #if __has_include(<bit>) && defined(__cplusplus) && __cplusplus >= 202002L
@@ -50,7 +49,7 @@ uint64_t murmur3_64(const std::string& key, uint64_t seed = 42) {
         h *= m;
     }
 
-    const unsigned char* tail = reinterpret_cast<const unsigned char*>(key.data()) + nblocks * 8;
+    const unsigned char* tail = reinterpret_cast<const unsigned char*>(data) + nblocks * 8;
     uint64_t rem = 0;
     switch (len & 7) {
         case 7: rem |= uint64_t(tail[6]) << 48; [[fallthrough]];
@@ -70,6 +69,10 @@ uint64_t murmur3_64(const std::string& key, uint64_t seed = 42) {
     return h;
 }
 
+uint64_t murmur3_64(const std::string& key, uint64_t seed = 42) {
+    return murmur3_64(key.data(), key.size(), seed);
+}
+
 uint64_t str_to_u64(const std::string& str) {
     return murmur3_64(str);
 }
\ No newline at end of file
@@ -7,6 +7,13 @@
 
 // ======== INCLUDE ======== //
 #include "../include/FQ-HLL/HyperLogLog.h"
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define FQHLL_X86_DISPATCH 1
+    #include <immintrin.h>
+#endif
 
 // ======== FALLBACK ======== //
 uint8_t clz(uint64_t num) {
@@ -31,22 +38,312 @@ uint8_t clz(uint64_t num) {
 #endif
 }
 
+// ======== REGISTER SUM ======== //
+// Sum of 2^-r over the registers and how many are 0, the two things estimate() needs, in a single pass.
+// Shifted inserts push registers past 64, so every uint8_t value gets its power.
+static const std::array<double, 256> POW2_NEG = [] {
+    std::array<double, 256> table{};
+    double v = 1.0;
+    for (int r = 0; r < 256; ++r) {
+        table[r] = v;
+        v *= 0.5;
+    }
+    return table;
+}();
+
+static double register_sum_portable(const uint8_t* registers, size_t m, size_t* zeros) {
+    double acc[4] = {0.0, 0.0, 0.0, 0.0}; // Independent adds, so the loop isn't one long dependency chain
+    size_t z = 0;
+    size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+        for (int k = 0; k < 4; ++k) {
+            acc[k] += POW2_NEG[registers[i + k]];
+            z += (registers[i + k] == 0);
+        }
+    }
+    for (; i < m; ++i) {
+        acc[0] += POW2_NEG[registers[i]];
+        z += (registers[i] == 0);
+    }
+
+    *zeros = z;
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+#ifdef FQHLL_X86_DISPATCH
+// ======== AVX2 ======== //
+// 2^-r built straight from its bits, exponent 1023 - r and a zero mantissa, 16 registers per step
+__attribute__((target("avx2"))) static inline __m256d pow2_neg4(__m128i four_bytes) {
+    const __m256i bias = _mm256_set1_epi64x(1023);
+    __m256i r = _mm256_cvtepu8_epi64(four_bytes);
+    return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_sub_epi64(bias, r), 52));
+}
+
+__attribute__((target("avx2,popcnt"))) static double register_sum_avx2(const uint8_t* registers, size_t m, size_t* zeros) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd(), acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+    const __m128i zero = _mm_setzero_si128();
+    size_t z = 0;
+    size_t i = 0;
+    for (; i + 16 <= m; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(registers + i));
+        z += _mm_popcnt_u32((unsigned)(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero))));
+
+        acc0 = _mm256_add_pd(acc0, pow2_neg4(v));
+        acc1 = _mm256_add_pd(acc1, pow2_neg4(_mm_srli_si128(v, 4)));
+        acc2 = _mm256_add_pd(acc2, pow2_neg4(_mm_srli_si128(v, 8)));
+        acc3 = _mm256_add_pd(acc3, pow2_neg4(_mm_srli_si128(v, 12)));
+    }
+
+    __m256d acc = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+
+    for (; i < m; ++i) { // Only for b < 4
+        sum += POW2_NEG[registers[i]];
+        z += (registers[i] == 0);
+    }
+
+    *zeros = z;
+    return sum;
+}
+#endif
+
+// ======== DISPATCH ======== //
+struct RegisterSumKernel {
+    double (*sum)(const uint8_t*, size_t, size_t*);
+    const char* name;
+};
+
+static RegisterSumKernel pick_register_sum() {
+#ifdef FQHLL_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return {register_sum_avx2, "avx2"};
+    }
+#endif
+    return {register_sum_portable, "portable"};
+}
+
+static const RegisterSumKernel& register_sum_kernel() {
+    static const RegisterSumKernel kernel = pick_register_sum();
+    return kernel;
+}
+
+const char* estimate_kernel_name() {
+    return register_sum_kernel().name;
+}
+
+// ======== SPARSE ENTRIES ======== //
+// (index << 8) | value, so sorting orders by index and then value
+static inline uint32_t entry_index(uint32_t e) {
+    return e >> 8;
+}
+
+static inline uint8_t entry_value(uint32_t e) {
+    return (uint8_t)(e & 0xFF);
+}
+
+// Sorted entries with unsorted updates applied, one entry per index holding the larger value
+static void merge_entries(const std::vector<uint32_t>& sorted, std::vector<uint32_t> updates, std::vector<uint32_t>& out) {
+    std::sort(updates.begin(), updates.end());
+    out.clear();
+    out.reserve(sorted.size() + updates.size());
+
+    auto push = [&](uint32_t e) {
+        if (!out.empty() && entry_index(out.back()) == entry_index(e)) {
+            out.back() = std::max(out.back(), e);
+        } else {
+            out.push_back(e);
+        }
+    };
+
+    size_t i = 0, j = 0;
+    while (i < sorted.size() || j < updates.size()) {
+        if (j == updates.size() || (i < sorted.size() && sorted[i] < updates[j])) {
+            push(sorted[i++]);
+        } else {
+            push(updates[j++]);
+        }
+    }
+}
+
+// ======== PACKED REGISTERS ======== //
+// 6 bits fit 10 fields in a word and 4 bits fit 16, so no field straddles two words and every word op stays
+// inside its fields. Fields past register m in the last word stay 0.
+struct PackedLayout {
+    int bits;
+    int per_word;
+    uint64_t ones; // One field of all ones, the overflow marker
+    uint64_t high; // Top bit of every field
+    uint64_t low; // Every other bit of every field
+};
+
+static constexpr PackedLayout make_layout(int bits) {
+    PackedLayout layout{bits, 64 / bits, (1ULL << bits) - 1, 0, 0};
+    for (int i = 0; i < layout.per_word; ++i) {
+        layout.high |= 1ULL << (i * bits + bits - 1);
+        layout.low |= ((1ULL << (bits - 1)) - 1) << (i * bits);
+    }
+    return layout;
+}
+
+static constexpr PackedLayout LAYOUT6 = make_layout(6);
+static constexpr PackedLayout LAYOUT4 = make_layout(4);
+
+static inline const PackedLayout& packed_layout(int bits) {
+    return (bits == 6 ? LAYOUT6 : LAYOUT4);
+}
+
+static inline int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Fieldwise max of two words. With the top bit forced on in a and off in b, no field borrows from the next.
+static inline uint64_t packed_max(uint64_t a, uint64_t b, const PackedLayout& L) {
+    uint64_t low_ge = (a | L.high) - (b & L.low); // Top bit of a field set where a's low bits >= b's
+    uint64_t ge = ((a & ~b) | (~(a ^ b) & low_ge)) & L.high;
+    uint64_t pick = (ge >> (L.bits - 1)) * L.ones; // Whole field of ones where a >= b
+    return (a & pick) | (b & ~pick);
+}
+
+// Fields of w that are not 0
+static inline int packed_nonzero(uint64_t w, const PackedLayout& L) {
+    return popcount64((((w & L.low) + L.low) | w) & L.high);
+}
+
+// Fieldwise w - d, 0 where that goes below, all-ones fields left as they are. d is at most L.ones.
+static inline uint64_t packed_sub_saturating(uint64_t w, uint64_t d, const PackedLayout& L) {
+    uint64_t dw = (L.high >> (L.bits - 1)) * d; // d in every field
+    uint64_t low_ge = (w | L.high) - (dw & L.low);
+    uint64_t ge = ((w & ~dw) | (~(w ^ dw) & low_ge)) & L.high;
+    uint64_t diff = ((w | L.high) - (dw & ~L.high)) ^ ((w ^ ~dw) & L.high);
+
+    uint64_t not_ones = ((((~w & L.low) + L.low) | ~w) & L.high); // Top bit of every field that isn't all ones
+    uint64_t keep = ((~not_ones & L.high) >> (L.bits - 1)) * L.ones;
+    return (w & keep) | (diff & ((ge >> (L.bits - 1)) * L.ones) & ~keep);
+}
+
+// Word i of a sketch re-encoded from base new_base - d to new_base. Overflow registers that now fit their field
+// move back into it, o walking the sorted overflow list alongside the words.
+static inline uint64_t packed_rebased_word(uint64_t w, size_t i, int d, int new_base, const std::vector<uint32_t>& overflow, size_t& o, const PackedLayout& L) {
+    w = packed_sub_saturating(w, std::min<uint64_t>(d, L.ones), L);
+    for (; o < overflow.size() && entry_index(overflow[o]) / L.per_word == i; ++o) {
+        int field = std::max(0, (int)(entry_value(overflow[o])) - new_base);
+        if (field < (int)(L.ones)) {
+            int shift = entry_index(overflow[o]) % L.per_word * L.bits;
+            w = (w & ~(L.ones << shift)) | ((uint64_t)(field) << shift);
+        }
+    }
+    return w;
+}
+
+// Overflow entries still past the all-ones field at new_base
+static std::vector<uint32_t> overflow_at_base(const std::vector<uint32_t>& overflow, int new_base, const PackedLayout& L) {
+    std::vector<uint32_t> kept;
+    for (uint32_t e : overflow) {
+        if ((int)(entry_value(e)) - new_base >= (int)(L.ones)) {
+            kept.push_back(e);
+        }
+    }
+    return kept;
+}
+
+// Two overflow lists as one. Neither repeats an index, so unlike merge_entries only matches need the max.
+static void merge_overflow(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out) {
+    out.resize(a.size() + b.size());
+    uint32_t* o = out.data();
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        uint32_t x = a[i], y = b[j];
+        if (entry_index(x) == entry_index(y)) {
+            *o++ = std::max(x, y);
+            ++i;
+            ++j;
+        } else {
+            *o++ = std::min(x, y);
+            i += (x < y);
+            j += (y < x);
+        }
+    }
+    o = std::copy(a.begin() + i, a.end(), o);
+    o = std::copy(b.begin() + j, b.end(), o);
+    out.resize(o - out.data());
+}
+
+// 2^-x + 2^-y for two neighbouring 6-bit fields x and y
+static const std::vector<double> PAIRS6 = [] {
+    std::vector<double> table(1 << 12);
+    for (size_t i = 0; i < table.size(); ++i) {
+        table[i] = POW2_NEG[i & 63] + POW2_NEG[i >> 6];
+    }
+    return table;
+}();
+
+// Linear counting below 2.5m, then the raw estimate with the large-range correction
+static double estimate_from_sum(double Z, size_t zeros, int m, double alpha_m) {
+    double TWO64 = exp2(64.0);
+
+    double E = alpha_m * m * m / Z;
+    double V = zeros;
+
+    if (E <= 2.5 * m) {
+        return (V != 0 ? m * log(m / V) : E);
+    } else if (E <= 1.0 / 30 * TWO64) {
+        return E;
+    } else {
+        return -1 * TWO64 * log(1.0 - E / TWO64);
+    }
+}
+
 // ======== HyperLogLog CLASS IMPLEMENTATION ======== //
 HyperLogLog::HyperLogLog() : HyperLogLog(SketchConfig()) {}
 
 HyperLogLog::HyperLogLog(const SketchConfig& _cfg) {
     if (_cfg.b > 16) { // Practical bounds
-        throw std::invalid_argument("Precision b must be less than 16.");
+        throw std::invalid_argument("Precision b must be at most 16.");
+    }
+    if (_cfg.register_bits != 8 && _cfg.register_bits != 6 && _cfg.register_bits != 4) {
+        throw std::invalid_argument("register_bits must be 8, 6 or 4.");
     }
 
     cfg = _cfg;
     m = 1 << cfg.b;
-    alpha_m = compute_alpha();
-    registers.assign(m, 0);
+    alpha_m = compute_alpha(cfg, m);
+
+    size_t dense_bytes = m;
+    if (cfg.register_bits != 8) {
+        const PackedLayout& L = packed_layout(cfg.register_bits);
+        dense_bytes = (m + L.per_word - 1) / L.per_word * sizeof(uint64_t);
+    }
+    sparse_max = dense_bytes / sizeof(uint32_t);
+    reset();
+}
+
+HyperLogLog::HyperLogLog(const SketchConfig& _cfg, const uint8_t* _registers) : HyperLogLog(_cfg) {
+    size_t set = std::count_if(_registers, _registers + m, [](uint8_t r) { return r != 0; });
+    if (!sparse || set > sparse_max) {
+        sparse = false;
+        assign_dense(_registers);
+        return;
+    }
+
+    entries.reserve(set);
+    for (int j = 0; j < m; ++j) {
+        if (_registers[j] != 0) {
+            entries.push_back(((uint32_t)(j) << 8) | _registers[j]);
+        }
+    }
 }
 
 // ======== PRIVATE ======= //
-double HyperLogLog::compute_alpha() {
+double HyperLogLog::compute_alpha(const SketchConfig& cfg, int m) {
     // Override
     if (cfg.alpha_override > 0) {
         return cfg.alpha_override;
@@ -71,8 +368,227 @@ uint8_t HyperLogLog::rho(uint64_t w_suffix) const {
     return clz(w_suffix) + 1;
 }
 
-uint8_t HyperLogLog::count_zero_registers() const {
-    return std::count_if(registers.begin(), registers.end(), [](uint8_t r) { return r == 0; });
+double HyperLogLog::estimate_registers(const uint8_t* registers, int m, double alpha_m) {
+    size_t zeros;
+    double Z = register_sum_kernel().sum(registers, m, &zeros);
+    return estimate_from_sum(Z, zeros, m, alpha_m);
+}
+
+double HyperLogLog::estimate_packed() const {
+    const PackedLayout& L = packed_layout(register_bits);
+
+    // The fields past register m in the last word are read as all ones, so they add next to nothing. As 0 they would
+    // add 2^0 each, and taking that back off loses the sum's digits once the registers are large.
+    size_t padding = packed.size() * L.per_word - m;
+    uint64_t last = packed.back() | (padding == 0 ? 0 : (L.high | L.low) & ~((1ULL << ((L.per_word - padding) * L.bits)) - 1));
+    auto word = [&](size_t i) { return (i + 1 == packed.size() ? last : packed[i]); };
+
+    // 4 bits: both nibbles of every byte split out to a byte each, 64 words at a time, for the byte register
+    // kernel (the order fields are summed in doesn't matter). 6 bits: one table lookup per pair of fields.
+    double sum = 0.0;
+    if (L.bits == 4) {
+        uint8_t fields[1024];
+        size_t zeros;
+        for (size_t w0 = 0; w0 < packed.size(); w0 += 64) {
+            size_t n = std::min<size_t>(64, packed.size() - w0);
+            for (size_t k = 0; k < n; ++k) {
+                uint64_t lo = word(w0 + k) & 0x0F0F0F0F0F0F0F0FULL, hi = (word(w0 + k) >> 4) & 0x0F0F0F0F0F0F0F0FULL;
+                std::memcpy(fields + 16 * k, &lo, 8);
+                std::memcpy(fields + 16 * k + 8, &hi, 8);
+            }
+            sum += register_sum_kernel().sum(fields, n * 16, &zeros);
+        }
+    } else {
+        double acc[2] = {0.0, 0.0};
+        for (size_t i = 0; i < packed.size(); ++i) {
+            uint64_t w = word(i);
+            for (int k = 0; k < 5; ++k) {
+                acc[k & 1] += PAIRS6[(w >> (12 * k)) & 0xFFF];
+            }
+        }
+        sum = acc[0] + acc[1];
+    }
+
+    // Each field past register m and each overflow register was counted as an all-ones field
+    double Z = std::ldexp(sum - std::ldexp((double)(padding), -(int)(L.ones)), -base);
+    for (uint32_t e : overflow) {
+        Z += POW2_NEG[entry_value(e)] - std::ldexp(1.0, -(base + (int)(L.ones)));
+    }
+
+    return estimate_from_sum(Z, (base == 0 ? base_count : 0), m, alpha_m);
+}
+
+void HyperLogLog::set_register(uint64_t j, int r) {
+    if (!sparse) {
+        if (register_bits != 8) {
+            set_packed(j, r);
+        } else if (r > registers[j]) {
+            registers[j] = r;
+        }
+        return;
+    }
+
+    if (r <= 0) { // A register never drops below 0
+        return;
+    }
+
+    // Batched, so each insert costs a push and the occasional merge instead of shifting the sorted list
+    pending.push_back(((uint32_t)(j) << 8) | (uint8_t)(r));
+    if (pending.size() >= std::min(std::max<size_t>(64, entries.size() / 4), sparse_max)) { // Never more than the dense bytes waiting
+        flush_pending();
+    }
+}
+
+void HyperLogLog::flush_pending() {
+    if (pending.empty()) {
+        return;
+    }
+
+    std::vector<uint32_t> merged;
+    merge_entries(entries, std::move(pending), merged);
+    entries.swap(merged);
+    pending.clear();
+
+    if (entries.size() > sparse_max) { // Past this the list takes more bytes than the registers
+        to_dense();
+    }
+}
+
+void HyperLogLog::to_dense() {
+    std::vector<uint8_t> values(m, 0);
+    write_registers(values.data());
+
+    sparse = false;
+    std::vector<uint32_t>().swap(entries);
+    std::vector<uint32_t>().swap(pending);
+    assign_dense(values.data());
+}
+
+void HyperLogLog::clear_dense() {
+    base = 0;
+    base_count = m;
+    overflow.clear();
+
+    if (register_bits == 8) {
+        registers.assign(m, 0);
+    } else {
+        const PackedLayout& L = packed_layout(register_bits);
+        packed.assign((m + L.per_word - 1) / L.per_word, 0);
+    }
+}
+
+void HyperLogLog::assign_dense(const uint8_t* values) {
+    if (register_bits == 8) {
+        registers.assign(values, values + m);
+        return;
+    }
+
+    const PackedLayout& L = packed_layout(register_bits);
+    clear_dense();
+    base = (L.bits == 4 ? *std::min_element(values, values + m) : 0);
+    base_count = 0;
+
+    for (int j = 0; j < m; ++j) {
+        uint64_t field = std::min<uint64_t>((uint64_t)(values[j] - base), L.ones);
+        if (field == L.ones) {
+            overflow.push_back(((uint32_t)(j) << 8) | values[j]); // In index order, so already sorted
+        }
+        base_count += (field == 0);
+        packed[j / L.per_word] |= field << (j % L.per_word * L.bits);
+    }
+    widen_if_overflowing();
+}
+
+void HyperLogLog::set_packed(uint64_t j, int r) {
+    const PackedLayout& L = packed_layout(register_bits);
+    uint64_t& word = packed[j / L.per_word];
+    int shift = j % L.per_word * L.bits;
+    uint64_t field = (word >> shift) & L.ones;
+
+    if (r <= base + (int)(field)) { // An all-ones field's register is at least that too
+        return;
+    }
+
+    if (field == L.ones) { // Already in overflow
+        auto it = std::lower_bound(overflow.begin(), overflow.end(), (uint32_t)(j) << 8);
+        *it = std::max(*it, ((uint32_t)(j) << 8) | (uint8_t)(r));
+        return;
+    }
+
+    uint64_t next = std::min<uint64_t>((uint64_t)(r - base), L.ones);
+    word = (word & ~(L.ones << shift)) | (next << shift);
+    if (next == L.ones) {
+        uint32_t e = ((uint32_t)(j) << 8) | (uint8_t)(r);
+        overflow.insert(std::lower_bound(overflow.begin(), overflow.end(), e), e);
+    }
+
+    if (field == 0 && --base_count == 0 && L.bits == 4) {
+        rebase(); // Widens too if need be
+    } else if (next == L.ones) {
+        widen_if_overflowing();
+    }
+}
+
+void HyperLogLog::rebase() {
+    std::vector<uint8_t> values(m);
+    write_registers(values.data());
+    assign_dense(values.data());
+}
+
+void HyperLogLog::merge_packed(const HyperLogLog& other) {
+    const PackedLayout& L = packed_layout(register_bits);
+    int new_base = std::max(base, other.base);
+    int d_mine = new_base - base, d_theirs = new_base - other.base; // At most one is not 0
+
+    // The lower side's registers under the higher base clamp to 0, which is right since the other side's are all at
+    // least that base
+    int nonzero = 0;
+    size_t o_mine = 0, o_theirs = 0;
+    for (size_t i = 0; i < packed.size(); ++i) {
+        uint64_t a = (d_mine == 0 ? packed[i] : packed_rebased_word(packed[i], i, d_mine, new_base, overflow, o_mine, L));
+        uint64_t b = (d_theirs == 0 ? other.packed[i] : packed_rebased_word(other.packed[i], i, d_theirs, new_base, other.overflow, o_theirs, L));
+        packed[i] = packed_max(a, b, L);
+        nonzero += packed_nonzero(packed[i], L);
+    }
+    base = new_base;
+
+    // A field is all ones where either side's was, and the larger overflow value wins where both were
+    if (d_mine != 0) {
+        overflow = overflow_at_base(overflow, new_base, L);
+    }
+    if (!other.overflow.empty()) {
+        std::vector<uint32_t> merged;
+        merge_overflow(overflow, (d_theirs == 0 ? other.overflow : overflow_at_base(other.overflow, new_base, L)), merged);
+        overflow.swap(merged);
+    }
+
+    base_count = m - nonzero; // The 0 fields past register m are never counted as nonzero
+    if (base_count == 0 && L.bits == 4) {
+        rebase();
+    } else {
+        widen_if_overflowing();
+    }
+}
+
+void HyperLogLog::widen_if_overflowing() {
+    if (register_bits == 8 || packed.size() * sizeof(uint64_t) + overflow.size() * sizeof(uint32_t) <= (size_t)(m)) {
+        return;
+    }
+
+    std::vector<uint8_t> values(m);
+    write_registers(values.data());
+    register_bits = 8;
+    std::vector<uint64_t>().swap(packed);
+    std::vector<uint32_t>().swap(overflow);
+    registers.swap(values);
+}
+
+const std::vector<uint32_t>& HyperLogLog::merged_entries(std::vector<uint32_t>& scratch) const {
+    if (pending.empty()) {
+        return entries;
+    }
+    merge_entries(entries, pending, scratch);
+    return scratch;
 }
 
 // ======== PUBLIC ======== //
@@ -80,10 +596,7 @@ void HyperLogLog::insert(uint64_t hash) {
     uint64_t j = hash >> (64 - cfg.b);
     uint64_t w = ((hash & cfg.mask) << cfg.b) & 0xFFFFFFFFFFFFFFFFULL;
 
-    int r = rho(w);
-    if (r > registers[j]) {
-        registers[j] = r;
-    }
+    set_register(j, rho(w));
 }
 
 void HyperLogLog::insert(const std::string& str) {
@@ -94,10 +607,7 @@ void HyperLogLog::shifted_insert(uint64_t hash, int shift) {
     uint64_t j = hash >> (64 - cfg.b);
     uint64_t w = ((hash & cfg.mask) << cfg.b) & 0xFFFFFFFFFFFFFFFFULL;;
 
-    int r = rho(w) + shift;
-    if (r > registers[j]) {
-        registers[j] = r;
-    }
+    set_register(j, rho(w) + shift);
 }
 
 void HyperLogLog::shifted_insert(const std::string& str, int shift) {
@@ -109,31 +619,136 @@ void HyperLogLog::merge(const HyperLogLog& other) {
         throw std::invalid_argument("Cannot merge HLLs with different number of registers");
     }
 
+    if (other.sparse) {
+        std::vector<uint32_t> scratch;
+        for (uint32_t e : other.merged_entries(scratch)) {
+            set_register(entry_index(e), entry_value(e));
+        }
+        return;
+    }
+
+    if (sparse) {
+        to_dense();
+    }
+
+    if (register_bits != 8 && register_bits == other.register_bits) {
+        merge_packed(other);
+        return;
+    }
+
+    // Otherwise a register at a time, as bytes
+    std::vector<uint8_t> values;
+    const uint8_t* theirs = other.registers.data();
+    if (other.register_bits != 8) {
+        values.resize(m);
+        other.write_registers(values.data());
+        theirs = values.data();
+    }
+
+    if (register_bits == 8) {
+        for (int i = 0; i < m; ++i) {
+            registers[i] = std::max(registers[i], theirs[i]);
+        }
+        return;
+    }
+
+    std::vector<uint8_t> mine(m);
+    write_registers(mine.data());
     for (int i = 0; i < m; ++i) {
-        registers[i] = std::max(registers[i], other.registers[i]);
+        mine[i] = std::max(mine[i], theirs[i]);
     }
+    assign_dense(mine.data());
 }
 
 double HyperLogLog::estimate() const {
-    double TWO64 = exp2(64.0);
+    if (!sparse && register_bits != 8) {
+        return estimate_packed();
+    } else if (!sparse) {
+        return estimate_registers(registers.data(), m, alpha_m);
+    }
 
+    // Every register missing from the list is 0 and adds 2^0
+    std::vector<uint32_t> scratch;
+    const std::vector<uint32_t>& all = merged_entries(scratch);
     double Z = 0;
-    for (uint8_t r : registers) {
-        Z += std::pow(2.0, -r);
+    for (uint32_t e : all) {
+        Z += POW2_NEG[entry_value(e)];
     }
 
-    double E = alpha_m * m * m / Z;
-    double V = count_zero_registers();
+    size_t zeros = m - all.size();
+    return estimate_from_sum(Z + zeros, zeros, m, alpha_m);
+}
 
-    if (E <= 2.5 * m) {
-        return (V != 0 ? m * log(m / V) : E);
-    } else if (E <= 1.0 / 30 * TWO64) {
-        return E;
-    } else {
-        return -1 * TWO64 * log(1.0 - E / TWO64);
+double HyperLogLog::estimate(const SketchConfig& cfg, const uint8_t* registers) {
+    if (cfg.b > 16) {
+        throw std::invalid_argument("Precision b must be at most 16.");
     }
+
+    int m = 1 << cfg.b;
+    return estimate_registers(registers, m, compute_alpha(cfg, m));
 }
 
 void HyperLogLog::reset() {
-    std::fill(registers.begin(), registers.end(), 0);
+    sparse = cfg.sparse;
+    register_bits = cfg.register_bits;
+    entries.clear();
+    pending.clear();
+
+    std::vector<uint8_t>().swap(registers);
+    std::vector<uint64_t>().swap(packed);
+    std::vector<uint32_t>().swap(overflow);
+    if (!sparse) {
+        clear_dense();
+    }
+}
+
+void HyperLogLog::compact() {
+    if (!sparse) {
+        overflow.shrink_to_fit();
+        return;
+    }
+
+    flush_pending(); // May go dense, which frees both lists anyway
+    entries.shrink_to_fit();
+    pending.shrink_to_fit();
+}
+
+std::vector<uint8_t> HyperLogLog::get_registers() const {
+    std::vector<uint8_t> out(m);
+    write_registers(out.data());
+    return out;
+}
+
+void HyperLogLog::write_registers(uint8_t* out) const {
+    if (!sparse && register_bits == 8) {
+        std::copy(registers.begin(), registers.end(), out);
+        return;
+    }
+
+    if (!sparse) {
+        const PackedLayout& L = packed_layout(register_bits);
+        size_t o = 0; // Overflow is in index order, one entry per all-ones field
+        for (size_t w = 0, j = 0; w < packed.size(); ++w) {
+            uint64_t word = packed[w];
+            for (int k = 0; k < L.per_word && j < (size_t)(m); ++k, ++j, word >>= L.bits) {
+                uint64_t field = word & L.ones;
+                out[j] = (field == L.ones ? entry_value(overflow[o++]) : (uint8_t)(base + field));
+            }
+        }
+        return;
+    }
+
+    std::fill(out, out + m, 0);
+    std::vector<uint32_t> scratch;
+    for (uint32_t e : merged_entries(scratch)) {
+        out[entry_index(e)] = entry_value(e);
+    }
+}
+
+bool HyperLogLog::is_sparse() const {
+    return sparse;
+}
+
+size_t HyperLogLog::register_bytes() const {
+    return registers.capacity() + packed.capacity() * sizeof(uint64_t) + (entries.capacity() + pending.capacity() + overflow.capacity()) * sizeof(uint32_t);
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: Intersect.cpp                      *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#include "../include/FQ-HLL/Intersect.h"
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define FQHLL_X86_DISPATCH 1
+    #include <immintrin.h>
+#endif
+
+// ======== SCALAR ======== //
+int intersect_count_merge(const uint16_t* a, size_t na, const uint16_t* b, size_t nb) {
+    size_t i = 0, j = 0;
+    int count = 0;
+
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (a[i] > b[j]) {
+            ++j;
+        } else {
+            ++count;
+            ++i;
+            ++j;
+        }
+    }
+
+    return count;
+}
+
+int intersect_count_gallop(const uint16_t* small, size_t ns, const uint16_t* large, size_t nl) {
+    size_t lo = 0;
+    int count = 0;
+
+    for (size_t i = 0; i < ns && lo < nl; ++i) {
+        uint16_t x = small[i];
+
+        // Double the step until we pass x, then binary search the last step
+        size_t step = 1, hi = lo;
+        while (hi < nl && large[hi] < x) {
+            lo = hi + 1;
+            hi += step;
+            step <<= 1;
+        }
+        hi = std::min(hi + 1, nl);
+
+        lo = std::lower_bound(large + lo, large + hi, x) - large;
+        if (lo < nl && large[lo] == x) {
+            ++count;
+            ++lo;
+        }
+    }
+
+    return count;
+}
+
+#ifdef FQHLL_X86_DISPATCH
+// ======== AVX2 ======== //
+// Keeps the smaller side (<= 64 ids) in registers and tests every id of the other side against all of it at once
+static const size_t SIMD_MAX_SMALL = 64;
+
+__attribute__((target("avx2"))) static int intersect_count_avx2(const uint16_t* small, size_t ns, const uint16_t* large, size_t nl) {
+    if (ns == 0) {
+        return 0;
+    }
+
+    // Pad with the last id, "any equal" below ignores duplicates
+    alignas(32) uint16_t buf[SIMD_MAX_SMALL];
+    std::copy(small, small + ns, buf);
+    size_t nregs = (ns + 15) / 16;
+    std::fill(buf + ns, buf + nregs * 16, small[ns - 1]);
+
+    __m256i regs[SIMD_MAX_SMALL / 16];
+    for (size_t r = 0; r < nregs; ++r) {
+        regs[r] = _mm256_load_si256((const __m256i*)(buf + r * 16));
+    }
+
+    int count = 0;
+    for (size_t j = 0; j < nl; ++j) {
+        __m256i x = _mm256_set1_epi16((short)large[j]);
+        __m256i eq = _mm256_cmpeq_epi16(regs[0], x);
+        for (size_t r = 1; r < nregs; ++r) {
+            eq = _mm256_or_si256(eq, _mm256_cmpeq_epi16(regs[r], x));
+        }
+        count += !_mm256_testz_si256(eq, eq);
+    }
+
+    return count;
+}
+
+static bool has_avx2() {
+    static const bool avx2 = []() {
+        __builtin_cpu_init();
+        return (bool)__builtin_cpu_supports("avx2");
+    }();
+    return avx2;
+}
+#endif
+
+// ======== DISPATCH ======== //
+int intersect_count(const uint16_t* a, size_t na, const uint16_t* b, size_t nb) {
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+
+#ifdef FQHLL_X86_DISPATCH
+    if (na <= SIMD_MAX_SMALL && has_avx2()) {
+        return intersect_count_avx2(a, na, b, nb);
+    }
+#endif
+
+    if (na * 16 < nb) {
+        return intersect_count_gallop(a, na, b, nb);
+    }
+    return intersect_count_merge(a, na, b, nb);
+}
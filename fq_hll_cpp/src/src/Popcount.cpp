@@ -0,0 +1,185 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: Popcount.cpp                       *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#include "../include/FQ-HLL/Popcount.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define FQHLL_X86_DISPATCH 1
+    #include <immintrin.h>
+#endif
+
+// ======== PORTABLE ======== //
+static inline int popcount64_portable(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+static int popcount_portable(const uint64_t* a, size_t n) {
+    int total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += popcount64_portable(a[i]);
+    }
+    return total;
+}
+
+static int and_popcount_portable(const uint64_t* a, const uint64_t* b, size_t n) {
+    int total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += popcount64_portable(a[i] & b[i]);
+    }
+    return total;
+}
+
+#ifdef FQHLL_X86_DISPATCH
+// ======== POPCNT ======== //
+// Without -mpopcnt, __builtin_popcountll compiles to a libgcc call, so even the scalar loop gains from this
+__attribute__((target("popcnt"))) static int popcount_popcnt(const uint64_t* a, size_t n) {
+    int total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += (int)_mm_popcnt_u64(a[i]);
+    }
+    return total;
+}
+
+__attribute__((target("popcnt"))) static int and_popcount_popcnt(const uint64_t* a, const uint64_t* b, size_t n) {
+    int total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += (int)_mm_popcnt_u64(a[i] & b[i]);
+    }
+    return total;
+}
+
+// ======== AVX2 ======== //
+// Nibble lookup (Mula). Rows are only a handful of 256-bit lanes wide, too short for Harley-Seal's CSA tree to pay off
+__attribute__((target("avx2"))) static inline __m256i popcount256(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+
+    __m256i lo = _mm256_and_si256(v, low_mask);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+
+    return _mm256_sad_epu8(cnt, _mm256_setzero_si256()); // Per 64-bit lane sums
+}
+
+__attribute__((target("avx2"))) static inline int hsum256(__m256i acc) {
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    return (int)(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+}
+
+__attribute__((target("avx2,popcnt"))) static int popcount_avx2(const uint64_t* a, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        acc = _mm256_add_epi64(acc, popcount256(va));
+    }
+
+    int total = hsum256(acc);
+    for (; i < n; ++i) {
+        total += (int)_mm_popcnt_u64(a[i]);
+    }
+    return total;
+}
+
+__attribute__((target("avx2,popcnt"))) static int and_popcount_avx2(const uint64_t* a, const uint64_t* b, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        acc = _mm256_add_epi64(acc, popcount256(_mm256_and_si256(va, vb)));
+    }
+
+    int total = hsum256(acc);
+    for (; i < n; ++i) {
+        total += (int)_mm_popcnt_u64(a[i] & b[i]);
+    }
+    return total;
+}
+
+// ======== AVX-512 VPOPCNTDQ ======== //
+__attribute__((target("avx512f,avx512vpopcntdq"))) static int popcount_avx512(const uint64_t* a, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512((const void*)(a + i))));
+    }
+
+    if (i < n) { // Masked tail, no scalar loop
+        __mmask8 m = (__mmask8)((1u << (n - i)) - 1);
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(m, a + i)));
+    }
+    return (int)_mm512_reduce_add_epi64(acc);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) static int and_popcount_avx512(const uint64_t* a, const uint64_t* b, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i va = _mm512_loadu_si512((const void*)(a + i));
+        __m512i vb = _mm512_loadu_si512((const void*)(b + i));
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_and_si512(va, vb)));
+    }
+
+    if (i < n) {
+        __mmask8 m = (__mmask8)((1u << (n - i)) - 1);
+        __m512i va = _mm512_maskz_loadu_epi64(m, a + i);
+        __m512i vb = _mm512_maskz_loadu_epi64(m, b + i);
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_and_si512(va, vb)));
+    }
+    return (int)_mm512_reduce_add_epi64(acc);
+}
+#endif
+
+// ======== DISPATCH ======== //
+struct PopcountKernels {
+    int (*popcount)(const uint64_t*, size_t);
+    int (*and_popcount)(const uint64_t*, const uint64_t*, size_t);
+    const char* name;
+};
+
+static PopcountKernels pick_kernels() {
+#ifdef FQHLL_X86_DISPATCH
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) {
+        return {popcount_avx512, and_popcount_avx512, "avx512vpopcntdq"};
+    } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return {popcount_avx2, and_popcount_avx2, "avx2"};
+    } else if (__builtin_cpu_supports("popcnt")) {
+        return {popcount_popcnt, and_popcount_popcnt, "popcnt"};
+    }
+#endif
+    return {popcount_portable, and_popcount_portable, "portable"};
+}
+
+static const PopcountKernels& kernels() {
+    static const PopcountKernels k = pick_kernels();
+    return k;
+}
+
+// ======== PUBLIC ======== //
+int popcount_words(const uint64_t* a, size_t n) {
+    return kernels().popcount(a, n);
+}
+
+int and_popcount_words(const uint64_t* a, const uint64_t* b, size_t n) {
+    return kernels().and_popcount(a, b, n);
+}
+
+const char* popcount_kernel_name() {
+    return kernels().name;
+}
@@ -0,0 +1,164 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: Snapshot.cpp                       *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#include "../include/FQ-HLL/Snapshot.h"
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define FQHLL_MMAP 1
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// ~~~~~~~~ VARIABLES ~~~~~~~~ //
+static const char SNAPSHOT_MAGIC[8] = {'F', 'Q', 'H', 'L', 'L', 'S', 'N', 'P'};
+static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order; // SNAPSHOT_BYTE_ORDER as written
+    uint64_t checksum; // murmur3_64 of every byte after the header
+    uint64_t file_size;
+    uint32_t section_count;
+    uint32_t reserved;
+    uint64_t sections[SNAP_SECTIONS][2]; // Offset and bytes
+};
+
+static size_t align_up(size_t n) {
+    return (n + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+}
+
+// ======== MappedFile CLASS ======== //
+MappedFile::MappedFile(const std::filesystem::path& path) {
+#ifdef FQHLL_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot map " + path.string());
+    }
+
+    void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (p == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + path.string());
+    }
+
+    base = (const char*)(p);
+    bytes = st.st_size;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+
+    bytes = in.tellg();
+    buffer.resize((bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    in.seekg(0);
+    in.read((char*)(buffer.data()), bytes);
+    base = (const char*)(buffer.data());
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef FQHLL_MMAP
+    if (base) {
+        ::munmap((void*)(base), bytes);
+    }
+#endif
+}
+
+const char* MappedFile::data() const {
+    return base;
+}
+
+size_t MappedFile::size() const {
+    return bytes;
+}
+
+// ======== SnapshotWriter CLASS ======== //
+void SnapshotWriter::write(const std::filesystem::path& path) const {
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.section_count = SNAP_SECTIONS;
+
+    size_t offset = align_up(sizeof(SnapshotHeader));
+    for (int i = 0; i < SNAP_SECTIONS; ++i) {
+        header.sections[i][0] = offset;
+        header.sections[i][1] = sections[i].second;
+        offset = align_up(offset + sections[i].second);
+    }
+    header.file_size = offset;
+
+    // Whole file in memory first, the checksum needs it contiguous
+    std::string out(offset, '\0');
+    for (int i = 0; i < SNAP_SECTIONS; ++i) {
+        if (sections[i].second > 0) {
+            std::memcpy(&out[header.sections[i][0]], sections[i].first, sections[i].second);
+        }
+    }
+
+    std::memcpy(&out[0], &header, sizeof(header));
+    header.checksum = murmur3_64(out.data() + sizeof(header), out.size() - sizeof(header));
+    std::memcpy(&out[0], &header, sizeof(header));
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open snapshot file: " + path.string());
+    }
+    file.write(out.data(), out.size());
+
+    if (!file) {
+        throw std::runtime_error("Failed to write snapshot file: " + path.string());
+    }
+}
+
+// ======== SnapshotReader CLASS ======== //
+SnapshotReader::SnapshotReader(std::shared_ptr<const MappedFile> _file, bool verify_checksum) : file(std::move(_file)) {
+    SnapshotHeader header;
+    if (file->size() < sizeof(header)) {
+        throw std::runtime_error("Not an FQ-HLL snapshot");
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        throw std::runtime_error("Not an FQ-HLL snapshot");
+    }
+    if (header.byte_order != SNAPSHOT_BYTE_ORDER) {
+        throw std::runtime_error("Snapshot was written with another byte order");
+    }
+    if (header.version != SNAPSHOT_VERSION || header.section_count != SNAP_SECTIONS) {
+        throw std::runtime_error("Snapshot version " + std::to_string(header.version) + " is not supported (expected " + std::to_string(SNAPSHOT_VERSION) + ")");
+    }
+    if (header.file_size != file->size()) {
+        throw std::runtime_error("Truncated snapshot");
+    }
+
+    for (int i = 0; i < SNAP_SECTIONS; ++i) {
+        uint64_t offset = header.sections[i][0];
+        uint64_t bytes = header.sections[i][1];
+        if (offset % SNAPSHOT_ALIGN != 0 || offset > file->size() || bytes > file->size() - offset) {
+            throw std::runtime_error("Corrupt snapshot section table");
+        }
+        sections[i] = {offset, bytes};
+    }
+
+    if (verify_checksum && murmur3_64(file->data() + sizeof(header), file->size() - sizeof(header)) != header.checksum) {
+        throw std::runtime_error("Snapshot checksum mismatch");
+    }
+}
@@ -0,0 +1,148 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: ThreadPool.cpp                     *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#include "../include/FQ-HLL/ThreadPool.h"
+#include <algorithm>
+
+// ======== ThreadPool CLASS IMPLEMENTATION ======== //
+ThreadPool::ThreadPool(int threads) {
+    participants = std::max(1, threads);
+
+    for (int i = 0; i < participants; ++i) {
+        queues.push_back(std::make_unique<TaskQueue>());
+    }
+
+    // Participant 0 is whoever calls parallel_for
+    for (int i = 1; i < participants; ++i) {
+        workers.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stopping = true;
+    }
+    cv_work.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::size() const {
+    return participants;
+}
+
+void ThreadPool::parallel_for(size_t n, const std::function<void(size_t, int)>& fn, size_t grain) {
+    if (n == 0) {
+        return;
+    }
+
+    grain = std::max<size_t>(1, grain);
+
+    // Waiting for a busy pool would run concurrent callers one at a time, so they run their own batch meanwhile
+    std::unique_lock<std::mutex> batch_lock(batch_m, std::try_to_lock);
+    if (participants == 1 || !batch_lock.owns_lock()) {
+        for (size_t i = 0; i < n; ++i) {
+            fn(i, 0);
+        }
+        return;
+    }
+
+    // The batch is set up before any of its ranges can be popped, workers still in run_one included
+    size_t chunks = (n + grain - 1) / grain;
+    {
+        std::lock_guard<std::mutex> lock(m);
+        pending = chunks;
+        error = nullptr;
+        ++generation;
+    }
+
+    // Deal contiguous runs of chunks to each participant, stealing evens them out later
+    for (int owner = 0; owner < participants; ++owner) {
+        TaskQueue& queue = *queues[owner];
+        std::lock_guard<std::mutex> lock(queue.m);
+        for (size_t c = owner * chunks / participants; c < (owner + 1) * chunks / participants; ++c) {
+            queue.ranges.push_back(Task{c * grain, std::min(n, (c + 1) * grain), &fn});
+        }
+    }
+    cv_work.notify_all();
+
+    while (run_one(0)) {}
+
+    std::unique_lock<std::mutex> lock(m);
+    cv_done.wait(lock, [&] { return pending == 0; });
+
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+// ======== PRIVATE ======== //
+bool ThreadPool::run_one(int self) {
+    Task task;
+    bool found = false;
+
+    // Own work first (newest), then steal the oldest from the others
+    for (int k = 0; k < participants && !found; ++k) {
+        TaskQueue& queue = *queues[(self + k) % participants];
+        std::lock_guard<std::mutex> lock(queue.m);
+
+        if (!queue.ranges.empty()) {
+            if (k == 0) {
+                task = queue.ranges.back();
+                queue.ranges.pop_back();
+            } else {
+                task = queue.ranges.front();
+                queue.ranges.pop_front();
+            }
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    try {
+        for (size_t i = task.begin; i < task.end; ++i) {
+            (*task.fn)(i, self);
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(m);
+        if (!error) {
+            error = std::current_exception();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m);
+    if (--pending == 0) {
+        cv_done.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::worker_loop(int self) {
+    size_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv_work.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        while (run_one(self)) {}
+    }
+}
@@ -0,0 +1,237 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: TypoTable.cpp                      *
+ ****************************************** */
+
+// ======== INCLUDE ======== //
+#include "../include/FQ-HLL/TypoTable.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+// ~~~~~~~~ VARIABLES ~~~~~~~~ //
+static const char TYPO_TABLE_MAGIC[8] = {'F', 'Q', 'H', 'L', 'L', 'T', 'T', '1'};
+static const uint32_t TYPO_TABLE_BYTE_ORDER = 0x01020304;
+static const uint64_t EMPTY_SLOT = ~0ULL;
+
+// ======== HELPERS ======== //
+static void put_bytes(std::string& out, const void* p, size_t n) {
+    out.append((const char*)(p), n);
+}
+
+static void put_string(std::string& out, const std::string& s) {
+    uint32_t len = s.size();
+    put_bytes(out, &len, sizeof(len));
+    out += s;
+}
+
+static void put_double(std::string& out, double x) {
+    put_bytes(out, &x, sizeof(x));
+}
+
+// Readers advance p, the constructor checked with entry_fits that every entry lies inside the entries
+static std::string get_string(const char*& p) {
+    uint32_t len;
+    std::memcpy(&len, p, sizeof(len));
+    p += sizeof(len);
+
+    std::string s(p, len);
+    p += len;
+    return s;
+}
+
+static double get_double(const char*& p) {
+    double x;
+    std::memcpy(&x, p, sizeof(x));
+    p += sizeof(x);
+    return x;
+}
+
+// Whether the entry at offset, with its k suggestions, ends within the bytes of entries
+static bool entry_fits(const char* entries, uint64_t bytes, uint64_t offset, uint32_t k) {
+    uint64_t pos = offset;
+    auto skip_string = [&] {
+        uint32_t len;
+        if (bytes - pos < sizeof(len)) {
+            return false;
+        }
+        std::memcpy(&len, entries + pos, sizeof(len));
+        pos += sizeof(len);
+        if (bytes - pos < len) {
+            return false;
+        }
+        pos += len;
+        return true;
+    };
+    auto skip_double = [&] {
+        if (bytes - pos < sizeof(double)) {
+            return false;
+        }
+        pos += sizeof(double);
+        return true;
+    };
+
+    if (offset > bytes || !skip_string() || !skip_string() || !skip_double()) {
+        return false;
+    }
+    for (uint32_t i = 0; i < k; ++i) {
+        if (!skip_string() || !skip_double()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ======== TypoTable CLASS: PUBLIC ======== //
+TypoTable::TypoTable(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open typo table: " + path.string());
+    }
+
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    if (data.size() < sizeof(Header)) {
+        throw std::runtime_error("Not a typo table: " + path.string());
+    }
+    std::memcpy(&header, data.data(), sizeof(Header));
+
+    if (std::memcmp(header.magic, TYPO_TABLE_MAGIC, sizeof(TYPO_TABLE_MAGIC)) != 0) {
+        throw std::runtime_error("Not a typo table: " + path.string());
+    }
+    if (header.byte_order != TYPO_TABLE_BYTE_ORDER) {
+        throw std::runtime_error("Typo table was written with another byte order: " + path.string());
+    }
+    if (header.slots == 0 || (header.slots & (header.slots - 1)) != 0 || header.slots > (data.size() - sizeof(Header)) / sizeof(Slot) ||
+        data.size() - sizeof(Header) - header.slots * sizeof(Slot) != header.bytes) {
+        throw std::runtime_error("Corrupt typo table: " + path.string());
+    }
+
+    // Every suggestion takes at least a length and a score, so a larger k can't be right
+    if (header.entries > 0 && (header.k == 0 || header.k > header.bytes / (sizeof(uint32_t) + sizeof(double)))) {
+        throw std::runtime_error("Corrupt typo table: " + path.string());
+    }
+
+    // find() reads whatever entry a slot points at and probes until an empty slot, so check both here once
+    uint64_t used = 0;
+    for (uint64_t i = 0; i < header.slots; ++i) {
+        if (slots()[i].offset == EMPTY_SLOT) {
+            continue;
+        }
+        if (!entry_fits(entries(), header.bytes, slots()[i].offset, header.k)) {
+            throw std::runtime_error("Corrupt typo table: " + path.string());
+        }
+        ++used;
+    }
+    if (used != header.entries || used == header.slots) {
+        throw std::runtime_error("Corrupt typo table: " + path.string());
+    }
+}
+
+void TypoTable::write(const std::filesystem::path& path, uint64_t fingerprint, int k, bool use_keyboard, const std::vector<std::pair<std::string, TypoEntry>>& entries) {
+    uint64_t slot_count = 1;
+    while (slot_count < 2 * entries.size()) {
+        slot_count <<= 1;
+    }
+
+    std::vector<Slot> table(slot_count, Slot{0, EMPTY_SLOT});
+    std::string bytes;
+
+    for (auto& [typo, entry] : entries) {
+        uint64_t hash = str_to_u64(typo);
+        uint64_t pos = hash & (slot_count - 1);
+        while (table[pos].offset != EMPTY_SLOT) {
+            pos = (pos + 1) & (slot_count - 1);
+        }
+        table[pos] = Slot{hash, (uint64_t)(bytes.size())};
+
+        put_string(bytes, typo);
+        put_string(bytes, entry.best);
+        put_double(bytes, entry.best_score);
+        for (int i = 0; i < k; ++i) {
+            put_string(bytes, entry.suggestions[i]);
+            put_double(bytes, entry.scores[i]);
+        }
+    }
+
+    Header header{};
+    std::memcpy(header.magic, TYPO_TABLE_MAGIC, sizeof(TYPO_TABLE_MAGIC));
+    header.byte_order = TYPO_TABLE_BYTE_ORDER;
+    header.k = k;
+    header.fingerprint = fingerprint;
+    header.use_keyboard = use_keyboard;
+    header.entries = entries.size();
+    header.slots = slot_count;
+    header.bytes = bytes.size();
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Failed to open typo table file: " + path.string());
+    }
+
+    out.write((const char*)(&header), sizeof(header));
+    out.write((const char*)(table.data()), table.size() * sizeof(Slot));
+    out.write(bytes.data(), bytes.size());
+    out.close(); // Flushes, so a full disk shows up here
+
+    if (!out) {
+        throw std::runtime_error("Failed to write typo table file: " + path.string());
+    }
+}
+
+bool TypoTable::find(const std::string& typo, TypoEntry& out) const {
+    uint64_t hash = str_to_u64(typo);
+    const Slot* table = slots();
+
+    uint64_t pos = hash & (header.slots - 1);
+    for (uint64_t probes = 0; probes < header.slots && table[pos].offset != EMPTY_SLOT; ++probes, pos = (pos + 1) & (header.slots - 1)) {
+        if (table[pos].hash != hash) {
+            continue;
+        }
+
+        const char* p = entries() + table[pos].offset;
+        if (get_string(p) != typo) {
+            continue;
+        }
+
+        out.best = get_string(p);
+        out.best_score = get_double(p);
+        out.suggestions.resize(header.k);
+        out.scores.resize(header.k);
+        for (uint32_t i = 0; i < header.k; ++i) {
+            out.suggestions[i] = get_string(p);
+            out.scores[i] = get_double(p);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+uint64_t TypoTable::fingerprint() const {
+    return header.fingerprint;
+}
+
+int TypoTable::k() const {
+    return header.k;
+}
+
+bool TypoTable::use_keyboard() const {
+    return header.use_keyboard != 0;
+}
+
+size_t TypoTable::size() const {
+    return header.entries;
+}
+
+// ======== TypoTable CLASS: PRIVATE ======== //
+const TypoTable::Slot* TypoTable::slots() const {
+    return (const Slot*)(data.data() + sizeof(Header));
+}
+
+const char* TypoTable::entries() const {
+    return data.data() + sizeof(Header) + header.slots * sizeof(Slot);
+}
@@ -0,0 +1,94 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: add_dictionary_test.cpp            *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    std::vector<std::string> queries;
+    std::ifstream in("test_files/typo_file.txt");
+    for (std::string line; std::getline(in, line);) {
+        queries.push_back(line);
+    }
+
+    // Words bringing qgrams the first ones never had, in both halves
+    std::vector<std::string> first = {"the", "of", "and", "to", "in", "is", "it", "you", "that", "he", "was", "for", "on", "are"};
+    std::vector<std::string> second = {"zqxjk", "qwjzx", "hello", "world", "zebra", "ostrich", "flamingo", "jukebox", "vex", "fjord"};
+
+    for (std::string row_format : {"dense", "sparse"}) {
+        std::cout << row_format << " rows\n";
+
+        AutocorrectorCfg cfg;
+        cfg.valid_letters = "";
+        cfg.row_format = row_format;
+
+        // 1) Growing past an exponent bump gives the same index as building everything at once
+        std::vector<std::string> all = first;
+        all.insert(all.end(), second.begin(), second.end());
+
+        cfg.dictionary_list = first;
+        Autocorrector grown(cfg);
+        grown.add_dictionary(second);
+
+        cfg.dictionary_list = all;
+        Autocorrector fresh(cfg);
+
+        grown.save_snapshot("grown.bin");
+        fresh.save_snapshot("fresh.bin");
+        check(read_file("grown.bin") == read_file("fresh.bin"), "exponent bump: same index as a fresh build");
+
+        // 2) Without a bump, new qgrams leave the old rows alone, so bitsets and postings still agree
+        cfg.dictionary_list = (std::filesystem::path("test_files") / "20k_shun4midx.txt").string();
+        cfg.use_postings = true;
+        Autocorrector postings(cfg);
+        cfg.use_postings = false;
+        Autocorrector bitsets(cfg);
+
+        std::vector<std::string> novel = {"zqxjk", "qwjzx", "xq", "jjjj", "q9q", "0x1f"};
+        postings.add_dictionary(novel);
+        bitsets.add_dictionary(novel);
+        check(postings.top3(queries).scores == bitsets.top3(queries).scores, "typo file: bitsets match postings after add");
+        check(bitsets.top3({"zqxj", "qwjz", "0x1"}).suggestions == postings.top3({"zqxj", "qwjz", "0x1"}).suggestions, "new words found through new qgrams");
+
+        // 3) Adding a word at a time stays proportional to the words added
+        std::vector<std::string> extra;
+        for (int i = 0; i < 2000; ++i) {
+            extra.push_back("zz" + std::to_string(i) + "q");
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& word : extra) {
+            bitsets.add_dictionary(word);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(4) << "     " << extra.size() << " single-word adds: " << seconds << "s\n";
+    }
+
+    std::filesystem::remove("grown.bin");
+    std::filesystem::remove("fresh.bin");
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": add_dictionary\n";
+    return failures == 0 ? 0 : 1;
+}
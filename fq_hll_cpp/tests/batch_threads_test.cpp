@@ -0,0 +1,93 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: batch_threads_test.cpp             *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main() {
+    std::vector<std::string> queries;
+    std::ifstream in("test_files/typo_file.txt");
+    for (std::string line; std::getline(in, line);) {
+        queries.push_back(line);
+    }
+
+    AutocorrectorCfg cfg;
+    cfg.valid_letters = "";
+    Autocorrector ac(cfg);
+
+    std::vector<int> thread_counts = {1, 2, 4, 8};
+    int hardware = std::thread::hardware_concurrency();
+    if (hardware > 8) {
+        thread_counts.push_back(hardware);
+    }
+
+    Result base_autocor;
+    Results base_top3;
+    double base_time = 0.0;
+    int failures = 0;
+
+    std::cout << "Hardware threads: " << hardware << ", queries per batch: " << queries.size() << "\n";
+
+    for (int threads : thread_counts) {
+        ac.set_threads(threads);
+
+        auto t0 = std::chrono::steady_clock::now();
+        Result autocor = ac.autocorrect(queries, "None", true, true);
+        Results top3_ans = ac.top3(queries, "None", true, true);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        bool same = true;
+        if (threads == 1) {
+            base_autocor = autocor;
+            base_top3 = top3_ans;
+            base_time = secs;
+        } else {
+            same = autocor.suggestions == base_autocor.suggestions && autocor.scores == base_autocor.scores && top3_ans.suggestions == base_top3.suggestions && top3_ans.scores == base_top3.scores;
+        }
+
+        std::cout << std::fixed << std::setprecision(3) << std::setw(2) << threads << " threads: " << secs << "s, " << std::setprecision(0) << (2 * queries.size() / secs) << " queries/s, "
+                  << std::setprecision(2) << (base_time / secs) << "x" << (same ? "" : " (MISMATCH)") << "\n";
+
+        if (!same) {
+            ++failures;
+        }
+    }
+
+    // Intra-query splitting runs one parallel_for per query, so many small queries back to back deal batch after
+    // batch while the workers are still finishing the last one
+    cfg.threads = 4;
+    cfg.intra_query = true;
+    cfg.intra_query_min_words = 0;
+    Autocorrector split(cfg);
+
+    int calls = 0;
+    bool same_split = true;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int round = 0; round < 3; ++round) {
+        for (const std::string& query : queries) {
+            Result one = split.autocorrect({query});
+            Results three = split.top3({query});
+            same_split = same_split && one.suggestions[query] == base_autocor.suggestions[query] && one.scores[query] == base_autocor.scores[query] &&
+                         three.suggestions[query] == base_top3.suggestions[query] && three.scores[query] == base_top3.scores[query];
+            calls += 2;
+        }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << std::fixed << std::setprecision(3) << "Intra-query, 4 threads: " << calls << " single-query calls in " << secs << "s" << (same_split ? "" : " (MISMATCH)") << "\n";
+    if (!same_split) {
+        ++failures;
+    }
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": batch results independent of thread count\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: dictionary_load_test.cpp           *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Usage: ./dictionary_load_test [lines], 10M by default
+int main(int argc, char** argv) {
+    size_t lines = (argc > 1 ? std::stoull(argv[1]) : 10000000);
+
+    auto seconds = [](auto fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Dictionary words with mixed case, invalid lines, empty lines and CRLF endings mixed in
+    std::vector<std::string> base;
+    std::ifstream in("../src/test_files/20k_shun4midx.txt");
+    for (std::string line; std::getline(in, line);) {
+        base.push_back(line);
+    }
+    if (base.empty()) {
+        std::cout << "FAIL: cannot read ../src/test_files/20k_shun4midx.txt, run this from the tests directory\n";
+        return 1;
+    }
+
+    {
+        std::ofstream out("big_dictionary.txt", std::ios::binary);
+        for (size_t i = 0; i < lines; ++i) {
+            std::string word = base[i % base.size()] + (i >= base.size() ? std::string(1, 'a' + (i / base.size()) % 26) : "");
+            if (i % 7 == 0) {
+                word[0] = std::toupper(word[0]);
+            }
+            if (i % 97 == 0) {
+                word += "1";
+            }
+            out << word << (i % 101 == 0 ? "\r\n" : (i % 103 == 0 ? "\n\n" : "\n"));
+        }
+    }
+
+    std::unordered_set<char> letters;
+    for (char c = 'a'; c <= 'z'; ++c) {
+        letters.insert(c);
+    }
+
+    // The previous path: one std::string per line, then load_words copies and lowercases them again
+    WordData legacy, serial, parallel;
+    double legacy_time = seconds([&] {
+        std::vector<std::string> raw;
+        std::ifstream file("big_dictionary.txt");
+        for (std::string line; std::getline(file, line);) {
+            if (!line.empty()) {
+                raw.push_back(line);
+            }
+        }
+        legacy = load_words(raw, letters);
+    });
+
+    double serial_time = seconds([&] { serial = load_word_file("big_dictionary.txt", letters); });
+
+    int threads = std::max(2u, std::thread::hardware_concurrency());
+    ThreadPool pool(threads);
+    double parallel_time = seconds([&] { parallel = load_word_file("big_dictionary.txt", letters, &pool); });
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Lines: " << lines << ", words kept: " << legacy.words.size() << "\n";
+    std::cout << "getline + load_words:      " << legacy_time << "s\n";
+    std::cout << "load_word_file:            " << serial_time << "s\n";
+    std::cout << "load_word_file, " << threads << " threads: " << parallel_time << "s\n";
+
+    bool same = serial.words == legacy.words && serial.display == legacy.display && parallel.words == legacy.words && parallel.display == legacy.display;
+    std::filesystem::remove("big_dictionary.txt");
+
+    std::cout << (same ? "PASS" : "FAIL") << ": same words and displays\n";
+    return same ? 0 : 1;
+}
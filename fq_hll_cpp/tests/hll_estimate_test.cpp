@@ -0,0 +1,117 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: hll_estimate_test.cpp              *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+// The estimator as it was, with the zero count widened past uint8_t
+static double reference_estimate(const std::vector<uint8_t>& registers, double alpha_m) {
+    double m = registers.size();
+    double Z = 0;
+    size_t zeros = 0;
+    for (uint8_t r : registers) {
+        Z += std::pow(2.0, -r);
+        zeros += (r == 0);
+    }
+
+    double E = alpha_m * m * m / Z;
+    double TWO64 = exp2(64.0);
+    if (E <= 2.5 * m) {
+        return (zeros != 0 ? m * log(m / zeros) : E);
+    } else if (E <= 1.0 / 30 * TWO64) {
+        return E;
+    }
+    return -1 * TWO64 * log(1.0 - E / TWO64);
+}
+
+static double alpha_of(int m) {
+    return (m == 16 ? 0.673 : (m == 32 ? 0.697 : (m == 64 ? 0.709 : 0.7213 / (1 + 1.079 / m))));
+}
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    std::cout << "     kernel: " << estimate_kernel_name() << "\n";
+    std::mt19937_64 rng(7);
+
+    // Every b, from nearly empty (linear counting) to full sketches with shifted registers past 64
+    for (int b = 4; b <= 16; ++b) {
+        SketchConfig cfg;
+        cfg.b = b;
+        int m = 1 << b;
+
+        bool close = true;
+        for (size_t n : {(size_t)(3), (size_t)(m) / 3, (size_t)(m) * 2, (size_t)(m) * 40}) {
+            HyperLogLog hll(cfg);
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t hash = rng();
+                if (i % 7 == 0) {
+                    hll.shifted_insert(hash, (int)(i % 65));
+                } else {
+                    hll.insert(hash);
+                }
+            }
+
+            double want = reference_estimate(hll.get_registers(), alpha_of(m));
+            double got = hll.estimate();
+            double mapped = HyperLogLog::estimate(cfg, hll.get_registers().data());
+            close = close && std::abs(got - want) <= 1e-9 * std::abs(want) && got == mapped;
+        }
+        check(close, "b = " + std::to_string(b) + " matches the reference");
+    }
+
+    // m >= 256 with most registers empty: the old uint8_t zero count wrapped here
+    SketchConfig cfg;
+    cfg.b = 10;
+    HyperLogLog sparse(cfg);
+    for (int i = 0; i < 20; ++i) {
+        sparse.insert(rng());
+    }
+    check(std::abs(sparse.estimate() - 20.0) < 2.0, "linear counting with over 255 empty registers");
+
+    // Speed on a full b = 16 sketch
+    cfg.b = 16;
+    HyperLogLog big(cfg);
+    for (int i = 0; i < 1 << 20; ++i) {
+        big.shifted_insert(rng(), i % 5);
+    }
+
+    auto seconds = [](auto fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    const int reps = 200;
+    volatile double sink = 0;
+    double before = seconds([&] {
+        for (int i = 0; i < reps; ++i) {
+            sink = sink + reference_estimate(big.get_registers(), alpha_of(1 << 16));
+        }
+    });
+    double after = seconds([&] {
+        for (int i = 0; i < reps; ++i) {
+            sink = sink + big.estimate();
+        }
+    });
+    std::cout << std::fixed << std::setprecision(4) << "     " << reps << " estimates at b = 16: pow " << before << "s, table " << after << "s (" << std::setprecision(1) << before / after << "x)\n";
+    check(after < before, "faster than std::pow per register");
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": hll estimate\n";
+    return failures == 0 ? 0 : 1;
+}
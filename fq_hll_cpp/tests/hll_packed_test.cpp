@@ -0,0 +1,255 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: hll_packed_test.cpp                *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+static bool same_sketch(const HyperLogLog& a, const HyperLogLog& b) {
+    return a.get_registers() == b.get_registers() && std::abs(a.estimate() - b.estimate()) <= 1e-9 * b.estimate();
+}
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    std::mt19937_64 rng(23);
+
+    // Packed sketches hold exactly what byte registers do, shifts past the field width included
+    for (int bits : {6, 4}) {
+        for (int b : {2, 4, 10, 14}) {
+            SketchConfig byte_cfg;
+            byte_cfg.b = b;
+            byte_cfg.sparse = false;
+            SketchConfig packed_cfg = byte_cfg;
+            packed_cfg.register_bits = bits;
+            SketchConfig sparse_cfg = packed_cfg;
+            sparse_cfg.sparse = true;
+
+            HyperLogLog bytes(byte_cfg), packed(packed_cfg), sparse(sparse_cfg);
+            bool agree = true;
+            for (int n = 1; n <= (8 << b); n *= 2) {
+                for (int i = n / 2; i < n; ++i) {
+                    uint64_t hash = rng();
+                    int shift = (int)(hash % 8) * 4; // Zipf shifts of a 20k word dictionary
+                    bytes.shifted_insert(hash, shift);
+                    packed.shifted_insert(hash, shift);
+                    sparse.shifted_insert(hash, shift);
+                }
+                agree = agree && same_sketch(packed, bytes) && same_sketch(sparse, bytes);
+            }
+            std::string tag = " (" + std::to_string(bits) + " bits, b = " + std::to_string(b) + ")";
+            check(agree, "same registers and estimate as bytes" + tag);
+
+            // Every merge direction, the packed pairs taking the word-at-a-time path
+            HyperLogLog small_bytes(byte_cfg), small_packed(packed_cfg), small_sparse(sparse_cfg);
+            for (int i = 0; i < (1 << b); ++i) {
+                uint64_t hash = rng();
+                int shift = (int)(hash % 8) * 4;
+                small_bytes.shifted_insert(hash, shift);
+                small_packed.shifted_insert(hash, shift);
+                small_sparse.shifted_insert(hash, shift);
+            }
+            HyperLogLog expected = bytes;
+            expected.merge(small_bytes);
+
+            bool merges = true;
+            for (const HyperLogLog* from : {&small_bytes, &small_packed, &small_sparse}) {
+                for (const HyperLogLog* into : {&bytes, &packed, &sparse}) {
+                    HyperLogLog got = *into;
+                    got.merge(*from);
+                    merges = merges && same_sketch(got, expected);
+
+                    HyperLogLog back = *from;
+                    back.merge(*into);
+                    merges = merges && same_sketch(back, expected);
+                }
+            }
+            check(merges, "merges in every layout" + tag);
+
+            HyperLogLog copied(packed_cfg, bytes.get_registers().data());
+            check(same_sketch(copied, bytes), "built from byte registers" + tag);
+
+            packed.reset();
+            check(packed.estimate() == 0.0 && packed.get_registers() == std::vector<uint8_t>(1 << b, 0), "reset" + tag);
+        }
+    }
+
+    bool threw = false;
+    try {
+        SketchConfig odd;
+        odd.register_bits = 5;
+        HyperLogLog sketch(odd);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "register_bits other than 8, 6 or 4 rejected");
+
+    // Packed sketches at different bases merge a word at a time, and keep taking inserts like bytes afterwards
+    bool mixed = true;
+    for (int trial = 0; trial < 400; ++trial) {
+        SketchConfig byte_cfg;
+        byte_cfg.b = (trial % 2 == 0 ? 4 : 10);
+        byte_cfg.sparse = false;
+        SketchConfig packed_cfg = byte_cfg;
+        packed_cfg.register_bits = (trial % 4 < 2 ? 4 : 6);
+
+        int m = 1 << byte_cfg.b;
+        std::vector<uint8_t> x(m), y(m);
+        int x_base = rng() % 40, y_base = rng() % 40;
+        for (int j = 0; j < m; ++j) {
+            x[j] = x_base + std::min<int>(__builtin_ctzll(rng() | (1ULL << 30)) * (rng() % 3), 60); // Some past the field
+            y[j] = y_base + std::min<int>(__builtin_ctzll(rng() | (1ULL << 30)) * (rng() % 3), 60);
+        }
+
+        for (bool swap : {false, true}) {
+            HyperLogLog bytes(byte_cfg, (swap ? y : x).data()), packed(packed_cfg, (swap ? y : x).data());
+            HyperLogLog other_bytes(byte_cfg, (swap ? x : y).data()), other_packed(packed_cfg, (swap ? x : y).data());
+            bytes.merge(other_bytes);
+            packed.merge(other_packed);
+            mixed = mixed && same_sketch(packed, bytes);
+
+            for (int i = 0; i < 4 * m; ++i) {
+                uint64_t hash = rng();
+                int shift = (int)(rng() % 48);
+                bytes.shifted_insert(hash, shift);
+                packed.shifted_insert(hash, shift);
+            }
+            mixed = mixed && same_sketch(packed, bytes);
+        }
+    }
+    check(mixed, "packed merges across bases");
+
+    // Memory of the index's qgram sketches over the 20k dictionary, same Zipf shifts as build_sketches
+    std::vector<std::string> words;
+    std::ifstream dict("../src/test_files/20k_shun4midx.txt");
+    for (std::string line; std::getline(dict, line);) {
+        words.push_back(line);
+    }
+
+    int num_buckets = 1 << ((int)(std::ceil(std::log2((double)(words.size())) / 2.0)));
+    int bucket_size = (int)(std::ceil(words.size() / num_buckets));
+
+    for (int b : {10, 14}) {
+        size_t byte_total = 0;
+        for (int bits : {8, 6, 4}) {
+            SketchConfig cfg;
+            cfg.b = b;
+            cfg.sparse = false;
+            cfg.register_bits = bits;
+
+            auto t0 = std::chrono::steady_clock::now();
+            std::unordered_map<std::string, HyperLogLog> sketches;
+            for (int i = 0; i < words.size(); ++i) {
+                int bucket_idx = std::min(num_buckets, (i + 1) / bucket_size + 1);
+                int shift = std::min((int)(std::floor(std::log2((double)(num_buckets) / (double)(bucket_idx)))) * 4, 64);
+                for (std::string& gram : extract_qgrams(words[i])) {
+                    sketches.try_emplace(gram, cfg).first->second.shifted_insert(gram + "_" + words[i], shift);
+                }
+            }
+            double build = seconds_since(t0);
+
+            size_t total = 0;
+            for (auto& [gram, sketch] : sketches) {
+                sketch.compact();
+                total += sketch.register_bytes();
+            }
+            if (bits == 8) {
+                byte_total = total;
+            }
+
+            // Every estimate, then all of them merged into one
+            t0 = std::chrono::steady_clock::now();
+            double sum = 0;
+            for (int round = 0; round < 10; ++round) {
+                for (auto& [gram, sketch] : sketches) {
+                    sum += sketch.estimate();
+                }
+            }
+            double estimate = seconds_since(t0) / 10;
+
+            t0 = std::chrono::steady_clock::now();
+            HyperLogLog all(cfg);
+            for (auto& [gram, sketch] : sketches) {
+                all.merge(sketch);
+            }
+            double merge = seconds_since(t0);
+
+            std::cout << "     b = " << b << ", " << bits << " bits: " << total / 1024 << " KiB (" << (int)(100.0 * total / byte_total) << "%), build " << build * 1000 << " ms, estimate all " << estimate * 1000 << " ms, merge all " << merge * 1000 << " ms\n";
+            if (bits == 4) {
+                check(total < byte_total, "4-bit sketches smaller than bytes (b = " + std::to_string(b) + ")");
+            } else if (bits == 6) {
+                check(total * 10 < byte_total * 9, "6-bit sketches 10% under bytes or more (b = " + std::to_string(b) + ")");
+            }
+        }
+    }
+
+    // The index gives the same answers whatever the register width
+    std::vector<std::string> queries;
+    std::ifstream in("test_files/typo_file.txt");
+    for (std::string line; std::getline(in, line);) {
+        queries.push_back(line);
+    }
+
+    AutocorrectorCfg ac_cfg;
+    ac_cfg.valid_letters = "";
+    Autocorrector bytes_ac(ac_cfg);
+    Results expected = bytes_ac.top3(queries);
+    bytes_ac.save_snapshot("packed_bytes.bin");
+
+    threw = false;
+    try {
+        AutocorrectorCfg odd = ac_cfg;
+        odd.register_bits = 5;
+        Autocorrector::from_snapshot("packed_bytes.bin", odd);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "register_bits other than 8, 6 or 4 rejected from snapshots");
+
+    for (int bits : {6, 4}) {
+        ac_cfg.register_bits = bits;
+        Autocorrector ac(ac_cfg);
+        Results got = ac.top3(queries);
+        check(got.suggestions == expected.suggestions && got.scores == expected.scores, "same top3 with " + std::to_string(bits) + "-bit registers");
+
+        // Snapshots store a byte per register either way, and packing again on the first edit keeps the answers
+        ac.save_snapshot("packed_bits.bin");
+        check(read_file("packed_bits.bin") == read_file("packed_bytes.bin"), "same snapshot with " + std::to_string(bits) + "-bit registers");
+
+        Autocorrector loaded = Autocorrector::from_snapshot("packed_bits.bin", ac_cfg);
+        loaded.add_dictionary(std::vector<std::string>{"zqxjk"});
+        ac.add_dictionary(std::vector<std::string>{"zqxjk"});
+        check(loaded.top3(queries).scores == ac.top3(queries).scores, "snapshot repacked on edit (" + std::to_string(bits) + " bits)");
+    }
+
+    std::filesystem::remove("packed_bytes.bin");
+    std::filesystem::remove("packed_bits.bin");
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": packed hll\n";
+    return failures == 0 ? 0 : 1;
+}
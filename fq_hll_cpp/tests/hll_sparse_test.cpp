@@ -0,0 +1,111 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: hll_sparse_test.cpp                *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+static bool same_sketch(const HyperLogLog& a, const HyperLogLog& b) {
+    return a.get_registers() == b.get_registers() && std::abs(a.estimate() - b.estimate()) <= 1e-9 * b.estimate();
+}
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    std::mt19937_64 rng(11);
+
+    // Sparse and dense sketches fed the same inserts agree at every size, across the switch to dense
+    for (int b : {4, 10, 14, 16}) {
+        SketchConfig dense_cfg;
+        dense_cfg.b = b;
+        dense_cfg.sparse = false;
+        SketchConfig sparse_cfg = dense_cfg;
+        sparse_cfg.sparse = true;
+
+        HyperLogLog dense(dense_cfg), sparse(sparse_cfg);
+        bool agree = true, was_sparse = sparse.is_sparse();
+        for (int n = 1; n <= (1 << b); n *= 2) {
+            for (int i = n / 2; i < n; ++i) {
+                uint64_t hash = rng();
+                int shift = (int)(hash % 3) * 4;
+                dense.shifted_insert(hash, shift);
+                sparse.shifted_insert(hash, shift);
+            }
+            agree = agree && same_sketch(sparse, dense);
+        }
+        std::string tag = " (b = " + std::to_string(b) + ")";
+        check(agree, "same registers and estimate as dense" + tag);
+        check(was_sparse && !sparse.is_sparse(), "starts sparse, goes dense when full" + tag);
+
+        // Merges in every combination
+        HyperLogLog small(sparse_cfg), small_dense(dense_cfg);
+        for (int i = 0; i < 20; ++i) {
+            uint64_t hash = rng();
+            small.insert(hash);
+            small_dense.insert(hash);
+        }
+        HyperLogLog a = small, c = small_dense, d = small_dense;
+        a.merge(small);
+        c.merge(small);
+        d.merge(small_dense);
+        check(a.is_sparse() == (b > 4) && same_sketch(a, d) && same_sketch(c, d), "sparse/dense merges" + tag);
+
+        HyperLogLog e = small;
+        e.merge(dense);
+        HyperLogLog f = dense;
+        f.merge(small);
+        check(same_sketch(e, f), "merging into a full sketch" + tag);
+
+        sparse.reset();
+        check(sparse.is_sparse() && sparse.estimate() == 0.0, "reset goes back to sparse" + tag);
+
+        // Copied in from registers (a mapped snapshot) stays sparse if it can
+        HyperLogLog copied(sparse_cfg, small_dense.get_registers().data());
+        check(copied.is_sparse() == (b > 4) && same_sketch(copied, small_dense), "built from registers" + tag); // 20 set of 16 is dense
+    }
+
+    // Memory of one sketch per q-gram over the 20k dictionary, the way the index builds them
+    std::vector<std::string> words;
+    std::ifstream dict("../src/test_files/20k_shun4midx.txt");
+    for (std::string line; std::getline(dict, line);) {
+        words.push_back(line);
+    }
+
+    for (int b : {10, 14}) {
+        SketchConfig cfg;
+        cfg.b = b;
+        std::unordered_map<std::string, HyperLogLog> sketches;
+        for (std::string& word : words) {
+            for (std::string& gram : extract_qgrams(word)) {
+                sketches.try_emplace(gram, cfg).first->second.insert(gram + "_" + word);
+            }
+        }
+
+        size_t sparse_bytes = 0, still_sparse = 0;
+        for (auto& [gram, sketch] : sketches) {
+            sketch.compact();
+            sparse_bytes += sketch.register_bytes();
+            still_sparse += sketch.is_sparse();
+        }
+        size_t dense_bytes = sketches.size() << b;
+        std::cout << "     b = " << b << ": " << sketches.size() << " grams (" << still_sparse << " sparse), " << sparse_bytes / 1024 << " KiB vs " << dense_bytes / 1024 << " KiB dense\n";
+        check(sparse_bytes * (b >= 14 ? 4 : 2) < dense_bytes, "q-gram sketches well under dense (b = " + std::to_string(b) + ")");
+    }
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": sparse hll\n";
+    return failures == 0 ? 0 : 1;
+}
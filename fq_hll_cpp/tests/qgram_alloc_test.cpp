@@ -0,0 +1,65 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: qgram_alloc_test.cpp               *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+// ======== ALLOCATION COUNTER ======== //
+static std::atomic<long long> allocations{0};
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main() {
+    std::vector<std::string> queries = {"hillo", "tsetign", "goobye", "haedhpoesn", "presbyterian", "a", ""};
+
+    // One reused buffer, so the measured calls below never need the heap
+    std::vector<QgramCode> buffer(256);
+    int failures = 0;
+
+    for (const std::string& query : queries) {
+        std::vector<QgramCode> expected = extract_qgram_codes(query, true); // Allocating wrapper, outside the count
+
+        long long before = allocations.load();
+        size_t n = extract_qgram_codes(std::string_view(query), buffer.data(), buffer.size(), true);
+
+        size_t visited = 0;
+        uint32_t checksum = 0;
+        for_each_qgram_code(query, true, [&](QgramCode code) {
+            ++visited;
+            checksum = checksum * 31 + code;
+        });
+        long long used = allocations.load() - before;
+
+        bool same = n == expected.size() && visited == n && std::equal(expected.begin(), expected.end(), buffer.begin());
+        std::cout << std::setw(14) << std::left << (query.empty() ? "[empty]" : query) << " -> " << n << " grams, " << used << " allocations" << (same ? "" : " (MISMATCH)") << " [" << checksum << "]\n";
+
+        if (used != 0 || !same) {
+            ++failures;
+        }
+    }
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": zero-allocation q-gram extraction\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: query_context_test.cpp             *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static bool same_stats(const PruneStats& a, const PruneStats& b) {
+    return a.words == b.words && a.size_pruned == b.size_pruned && a.prefix_skipped == b.prefix_skipped && a.jaccard_pruned == b.jaccard_pruned &&
+           a.scored == b.scored && a.fallbacks == b.fallbacks && a.dp_cells == b.dp_cells && a.dp_cells_saved == b.dp_cells_saved;
+}
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    std::vector<std::string> queries;
+    std::ifstream in("test_files/typo_file.txt");
+    for (std::string line; std::getline(in, line);) {
+        queries.push_back(line);
+    }
+
+    AutocorrectorCfg cfg;
+    cfg.valid_letters = "";
+    cfg.use_pruning = true;
+    Autocorrector built(cfg);
+    const Autocorrector& ac = built; // Queries only need a const one
+
+    QueryContext serial;
+    Result expected = ac.autocorrect(queries, serial);
+    Results expected3 = ac.top3(queries, serial);
+    QueryContext serial_best;
+    ac.autocorrect(queries, serial_best);
+
+    // One index, every thread with its own context, same answers and stats as alone
+    const int threads = 4;
+    std::vector<Result> best(threads);
+    std::vector<Results> top(threads);
+    std::vector<QueryContext> contexts(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int round = 0; round < 3; ++round) {
+                top[t] = ac.top3(queries, contexts[t]);
+                best[t] = ac.autocorrect(queries, contexts[t]);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    bool same_answers = true, same_counts = true;
+    for (int t = 0; t < threads; ++t) {
+        same_answers = same_answers && best[t].scores == expected.scores && top[t].scores == expected3.scores;
+        same_counts = same_counts && same_stats(contexts[t].stats, serial_best.stats);
+    }
+    check(same_answers, "shared const Autocorrector, answers match a single thread");
+    check(same_counts, "each context keeps its own call's prune stats");
+    check(contexts[0].query_seconds > 0.0, "context records the query time");
+
+    // Same with a pool: callers that find it busy answer their batch themselves instead of queueing for it
+    AutocorrectorCfg pooled_cfg = cfg;
+    pooled_cfg.threads = 4;
+    const Autocorrector pooled(pooled_cfg);
+    std::vector<QueryContext> pooled_contexts(threads);
+    workers.clear();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int round = 0; round < 3; ++round) {
+                top[t] = pooled.top3(queries, pooled_contexts[t]);
+                best[t] = pooled.autocorrect(queries, pooled_contexts[t]);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    same_answers = true;
+    same_counts = true;
+    for (int t = 0; t < threads; ++t) {
+        same_answers = same_answers && best[t].scores == expected.scores && top[t].scores == expected3.scores;
+        same_counts = same_counts && same_stats(pooled_contexts[t].stats, serial_best.stats);
+    }
+    check(same_answers && same_counts, "callers sharing one pooled Autocorrector, answers and stats match");
+
+    // Scratch only for the participants a call can use, and posting counters only when postings are merged
+    AutocorrectorCfg scan_cfg = cfg;
+    scan_cfg.use_postings = false;
+    const Autocorrector scan(scan_cfg);
+    QueryContext scan_ctx;
+    scan.autocorrect(queries, scan_ctx);
+
+    AutocorrectorCfg split_cfg = pooled_cfg;
+    split_cfg.intra_query = true;
+    split_cfg.intra_query_min_words = 0;
+    const Autocorrector split(split_cfg);
+    QueryContext split_ctx;
+    split.autocorrect({queries[0]}, split_ctx);
+
+    check(serial.scratches.size() == 1 && pooled_contexts[0].scratches.size() == 4 && split_ctx.scratches.size() == 1, "one scratch per participant in use");
+    check(scan_ctx.scratches[0].posting_counts.empty() && !serial.scratches[0].posting_counts.empty(), "posting counters only with use_postings");
+
+    // The calls without a context use a thread-local one, and agree
+    check(ac.top3(queries).scores == expected3.scores, "thread-local context matches");
+
+    // prune_stats() is that context's, so another thread's calls never show up in it
+    ac.autocorrect(queries);
+    PruneStats other_thread;
+    std::thread([&] { ac.top3({"helo"}); other_thread = ac.prune_stats(); }).join();
+    check(same_stats(ac.prune_stats(), serial_best.stats) && !same_stats(other_thread, serial_best.stats), "prune_stats is per calling thread");
+
+    // print_times only reports, it no longer rebuilds the index
+    built.add_dictionary(std::vector<std::string>{"zqxjk", "qwjzx"});
+    built.save_snapshot("context_before.bin");
+    ac.autocorrect({"helo"}, "None", true, true, false, true);
+    built.save_snapshot("context_after.bin");
+    check(read_file("context_before.bin") == read_file("context_after.bin"), "print_times leaves the index alone");
+
+    std::filesystem::remove("context_before.bin");
+    std::filesystem::remove("context_after.bin");
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": query context\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: rcu_stress_test.cpp                *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    std::vector<std::string> queries;
+    std::ifstream in("test_files/typo_file.txt");
+    for (std::string line; std::getline(in, line) && queries.size() < 40;) {
+        queries.push_back(line);
+    }
+
+    // Added and removed together, so any one version has both or neither
+    std::vector<std::string> pair = {"zqxjkv", "vkjxqz"};
+    std::vector<std::string> probe = queries;
+    probe.insert(probe.end(), pair.begin(), pair.end());
+
+    // Batches split across the pool as well, so pool workers read the published version too
+    std::vector<std::tuple<int, size_t, std::string>> passes = {{1, 0, ""}, {1, 256, " (cached)"}, {4, 0, " (4 threads)"}, {4, 256, " (4 threads, cached)"}};
+    for (auto& [threads, cache, tag] : passes) {
+
+        AutocorrectorCfg cfg;
+        cfg.valid_letters = "";
+        cfg.cache_capacity = cache;
+        cfg.threads = threads;
+        Autocorrector ac(cfg);
+        Results before = ac.top3(queries);
+
+        std::atomic<bool> done{false};
+        std::atomic<int> torn{0}, reads{0}, seen_with{0}, seen_without{0};
+
+        // Readers never wait for the writer, and each call sees exactly one published version
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; ++r) {
+            readers.emplace_back([&, r] {
+                while (!done.load()) {
+                    Results got = (r % 2 ? ac.top3(probe) : ac.top_k(probe, 1));
+                    bool first = got.suggestions[pair[0]][0] == pair[0];
+                    bool second = got.suggestions[pair[1]][0] == pair[1];
+                    if (first != second) {
+                        ++torn;
+                    }
+                    ++(first ? seen_with : seen_without);
+                    ++reads;
+                }
+            });
+        }
+
+        // Meanwhile add and remove the pair, plus a stream of single words that grows the index
+        std::thread writer([&] {
+            for (int i = 0; i < 200; ++i) {
+                ac.add_dictionary(pair);
+                ac.add_dictionary("zz" + std::to_string(i) + "q");
+                ac.remove_dictionary(pair);
+            }
+            ac.add_dictionary(pair);
+            done = true;
+        });
+
+        writer.join();
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+
+        std::cout << "     " << reads.load() << " reads, " << seen_with.load() << " with the pair, " << seen_without.load() << " without\n";
+        check(torn.load() == 0, "no call sees half an edit" + tag);
+
+        Results after = ac.top3(probe);
+        check(after.suggestions[pair[0]][0] == pair[0] && after.suggestions[pair[1]][0] == pair[1], "last edit visible once published" + tag);
+
+        bool unchanged = true;
+        for (const std::string& query : queries) {
+            unchanged = unchanged && after.suggestions[query] == before.suggestions[query];
+        }
+        check(unchanged, "other answers unaffected" + tag);
+    }
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": concurrent reads during edits\n";
+    return failures == 0 ? 0 : 1;
+}
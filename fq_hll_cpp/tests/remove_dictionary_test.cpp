@@ -0,0 +1,133 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: remove_dictionary_test.cpp         *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    std::vector<std::string> queries, dictionary;
+    std::ifstream in("test_files/typo_file.txt");
+    for (std::string line; std::getline(in, line);) {
+        queries.push_back(line);
+    }
+    std::ifstream dict("../src/test_files/20k_shun4midx.txt");
+    for (std::string line; std::getline(dict, line);) {
+        dictionary.push_back(line);
+    }
+    if (queries.empty() || dictionary.empty()) {
+        std::cout << "FAIL: cannot read test_files/typo_file.txt and ../src/test_files/20k_shun4midx.txt, run this from the tests directory\n";
+        return 1;
+    }
+
+    // Every 23rd word, well under compact_threshold
+    std::vector<std::string> gone;
+    for (size_t i = 0; i < dictionary.size(); i += 23) {
+        gone.push_back(dictionary[i]);
+    }
+
+    auto seconds = [](auto fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    Results reference;
+    for (std::string row_format : {"dense", "sparse"}) {
+        for (bool use_postings : {true, false}) {
+            std::string tag = " (" + row_format + (use_postings ? ", postings)" : ", rows)");
+
+            AutocorrectorCfg cfg;
+            cfg.valid_letters = "";
+            cfg.row_format = row_format;
+            cfg.use_postings = use_postings;
+            Autocorrector ac(cfg);
+
+            // A split query's chunks start mid-block, so they have to mask the tombstones the same way
+            cfg.threads = 3;
+            cfg.intra_query = true;
+            cfg.intra_query_min_words = 0;
+            Autocorrector split(cfg);
+
+            double before = seconds([&] { ac.top3(queries); });
+            ac.remove_dictionary(gone);
+            split.remove_dictionary(gone);
+            Results got;
+            double after = seconds([&] { got = ac.top3(queries); });
+            std::cout << std::fixed << std::setprecision(4) << "     top3 before " << before << "s, with " << gone.size() << " removed " << after << "s\n";
+
+            bool none_removed = true;
+            std::unordered_set<std::string> gone_set(gone.begin(), gone.end());
+            for (auto& [query, words] : got.suggestions) {
+                for (const std::string& word : words) {
+                    if (gone_set.count(word) && word != query) {
+                        none_removed = false;
+                    }
+                }
+            }
+            check(none_removed, "removed words never suggested" + tag);
+
+            if (reference.suggestions.empty()) {
+                reference = got;
+            }
+            check(got.scores == reference.scores, "same answers as dense postings" + tag);
+            check(split.top3(queries).scores == got.scores, "split query matches" + tag);
+
+            // Tombstones survive a snapshot
+            ac.save_snapshot("tombstones.bin");
+            check(Autocorrector::from_snapshot("tombstones.bin", cfg).top3(queries).scores == got.scores, "snapshot keeps removals" + tag);
+
+            // Adding a word back revives it in place
+            ac.add_dictionary(gone[1]);
+            check(ac.top3({gone[1]}).suggestions[gone[1]][0] == gone[1], "re-added word suggested again" + tag);
+        }
+    }
+
+    // compact_threshold: 10% of the words removed compacts them away, same as a fresh build without them
+    AutocorrectorCfg cfg;
+    cfg.valid_letters = "";
+    Autocorrector ac(cfg);
+
+    // Removal takes every copy of a word, whatever its case
+    auto lower = [](std::string word) {
+        std::transform(word.begin(), word.end(), word.begin(), ::tolower);
+        return word;
+    };
+    std::vector<std::string> tenth, kept;
+    std::unordered_set<std::string> tenth_set;
+    for (size_t i = 3; i < dictionary.size(); i += 10) {
+        tenth.push_back(dictionary[i]);
+        tenth_set.insert(lower(dictionary[i]));
+    }
+    for (const std::string& word : dictionary) {
+        if (!tenth_set.count(lower(word))) {
+            kept.push_back(word);
+        }
+    }
+    ac.remove_dictionary(tenth);
+
+    cfg.dictionary_list = kept;
+    Autocorrector fresh(cfg);
+    check(ac.fingerprint() == fresh.fingerprint() && ac.top3(queries).scores == fresh.top3(queries).scores, "compaction at compact_threshold");
+
+    std::filesystem::remove("tombstones.bin");
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": remove_dictionary\n";
+    return failures == 0 ? 0 : 1;
+}
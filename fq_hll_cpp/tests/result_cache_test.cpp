@@ -0,0 +1,68 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: result_cache_test.cpp              *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <iostream>
+#include <string>
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    // Skewed traffic: a few misspellings over and over
+    std::vector<std::string> queries;
+    for (int rep = 0; rep < 50; ++rep) {
+        for (std::string typo : {"teh", "recieve", "wrold", "helo", "adress", "becuase"}) {
+            queries.push_back(typo);
+        }
+    }
+
+    AutocorrectorCfg cfg;
+    cfg.dictionary_list = "test_files/database.txt";
+    cfg.valid_letters = "";
+    Autocorrector plain(cfg);
+
+    cfg.cache_capacity = 4; // Smaller than the 6 distinct queries, so CLOCK has to evict
+    cfg.threads = 4;
+    Autocorrector cached(cfg);
+
+    // 1) Same answers, mostly from the cache
+    Result expected = plain.autocorrect(queries);
+    Result got = cached.autocorrect(queries);
+    Results expected3 = plain.top3(queries);
+    Results got3 = cached.top3(queries);
+    check(got.suggestions == expected.suggestions && got.scores == expected.scores, "autocorrect matches the uncached run");
+    check(got3.suggestions == expected3.suggestions && got3.scores == expected3.scores, "top3 matches the uncached run");
+
+    CacheStats stats = cached.cache_stats();
+    std::cout << "     hits " << stats.hits << ", misses " << stats.misses << ", evictions " << stats.evictions << "\n";
+    check(stats.hits + stats.misses == 2 * queries.size(), "every query looked up once");
+    check(stats.hits > 0 && stats.evictions > 0, "hits and evictions counted");
+
+    // 2) Dictionary changes invalidate
+    plain.add_dictionary(std::vector<std::string>{"teh"});
+    cached.add_dictionary(std::vector<std::string>{"teh"});
+    got = cached.autocorrect({"teh"});
+    check(got.suggestions["teh"] == plain.autocorrect({"teh"}).suggestions["teh"] && got.suggestions["teh"] == "teh", "add_dictionary invalidates");
+
+    plain.remove_dictionary(std::vector<std::string>{"teh"});
+    cached.remove_dictionary(std::vector<std::string>{"teh"});
+    got = cached.autocorrect({"teh"});
+    check(got.suggestions["teh"] == plain.autocorrect({"teh"}).suggestions["teh"] && got.suggestions["teh"] != "teh", "remove_dictionary invalidates");
+
+    // 3) Flags are part of the key
+    got = cached.autocorrect({"recieve"}, "None", false);
+    check(got.scores["recieve"] == plain.autocorrect({"recieve"}, "None", false).scores["recieve"], "use_keyboard keyed separately");
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": result cache\n";
+    return failures == 0 ? 0 : 1;
+}
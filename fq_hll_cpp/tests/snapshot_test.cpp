@@ -0,0 +1,114 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: snapshot_test.cpp                  *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    auto seconds = [](auto fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::vector<std::string> queries;
+    std::ifstream in("test_files/typo_file.txt");
+    for (std::string line; std::getline(in, line);) {
+        queries.push_back(line);
+    }
+
+    for (std::string row_format : {"dense", "sparse"}) {
+        std::cout << row_format << " rows\n";
+
+        AutocorrectorCfg cfg;
+        cfg.valid_letters = "";
+        cfg.row_format = row_format;
+
+        Autocorrector built(cfg);
+        Autocorrector mapped(cfg); // Replaced below
+        double build_time = seconds([&] { built = Autocorrector(cfg); });
+        built.save_snapshot("snapshot.bin");
+        double load_time = seconds([&] { mapped = Autocorrector::from_snapshot("snapshot.bin", cfg); });
+        std::cout << std::fixed << std::setprecision(4) << "     build " << build_time << "s, load " << load_time << "s\n";
+
+        // 1) Same answers straight from the mapping
+        check(mapped.fingerprint() == built.fingerprint(), "same fingerprint");
+        check(mapped.autocorrect(queries).scores == built.autocorrect(queries).scores, "autocorrect matches");
+        check(mapped.top3(queries).suggestions == built.top3(queries).suggestions, "top3 matches");
+
+        // 2) Re-saving a mapped index gives the same file
+        mapped.save_snapshot("snapshot2.bin");
+        check(read_file("snapshot.bin") == read_file("snapshot2.bin"), "re-saved snapshot identical");
+
+        // 3) Changes copy out of the mapping first
+        built.add_dictionary(std::vector<std::string>{"teh", "wrold"});
+        mapped.add_dictionary(std::vector<std::string>{"teh", "wrold"});
+        built.remove_dictionary(std::vector<std::string>{"the"});
+        mapped.remove_dictionary(std::vector<std::string>{"the"});
+        check(mapped.top3(queries).scores == built.top3(queries).scores, "add/remove after loading matches");
+    }
+
+    // 4) Damaged files never load: ids and offsets are always checked, every byte only with verify_checksum
+    std::string good = read_file("snapshot.bin");
+    auto rejected = [](const std::string& bytes, bool verify_checksum) {
+        std::ofstream("snapshot.bin", std::ios::binary) << bytes;
+        try {
+            Autocorrector::from_snapshot("snapshot.bin", AutocorrectorCfg(), verify_checksum);
+        } catch (const std::runtime_error& e) {
+            std::cout << "     " << e.what() << "\n";
+            return true;
+        }
+        return false;
+    };
+
+    // The section table follows the 40-byte header, an (offset, bytes) pair per section
+    auto section_at = [&](SnapshotSection id) {
+        uint64_t offset;
+        std::memcpy(&offset, good.data() + 40 + 16 * id, sizeof(offset));
+        return offset;
+    };
+    auto with = [&](size_t at, auto value) {
+        std::string bytes = good;
+        std::memcpy(&bytes[at], &value, sizeof(value));
+        return bytes;
+    };
+
+    std::string flipped = good;
+    flipped[flipped.size() / 2] ^= 0x01;
+    check(rejected(flipped, true), "checksum mismatch rejected");
+    check(rejected(good.substr(0, good.size() / 2), false), "truncated file rejected");
+    check(rejected(with(section_at(SNAP_META) + 24, (int32_t)(40)), false), "impossible b rejected");
+    check(rejected(with(section_at(SNAP_WORD_OFFSETS) + 8, ~0ULL), false), "word offset past the chars rejected");
+    check(rejected(with(section_at(SNAP_QGRAM_IDX), (int32_t)(1 << 30)), false), "qgram idx past the qgrams rejected");
+    check(rejected(with(section_at(SNAP_POSTING_WORDS), (int32_t)(1 << 30)), false), "posting word id past the words rejected");
+    check(!rejected(good, false), "intact file still loads");
+
+    std::filesystem::remove("snapshot.bin");
+    std::filesystem::remove("snapshot2.bin");
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": snapshot\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: stream_test.cpp                    *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    AutocorrectorCfg cfg;
+    cfg.valid_letters = "";
+    cfg.threads = 2;
+    Autocorrector ac(cfg);
+
+    // The batch API's output files are the reference
+    Result expected = ac.autocorrect("test_files/typo_file.txt", "stream_expected.txt");
+    std::string expected_lines = read_file("stream_expected.txt");
+    Results expected3 = ac.top3("test_files/typo_file.txt", "stream_expected.txt");
+    std::string expected3_lines = read_file("stream_expected.txt");
+    std::filesystem::remove("stream_expected.txt");
+
+    for (size_t chunk_size : {1, 7, 4096}) {
+        std::string tag = " (chunks of " + std::to_string(chunk_size) + ")";
+
+        std::ifstream in("test_files/typo_file.txt");
+        std::ostringstream out;
+        Result got = ac.autocorrect_stream(in, out, true, true, chunk_size, true);
+        check(out.str() == expected_lines && got.suggestions == expected.suggestions && got.scores == expected.scores, "autocorrect_stream" + tag);
+
+        std::ifstream in3("test_files/typo_file.txt");
+        std::ostringstream out3;
+        Results got3 = ac.top_k_stream(in3, out3, 3, true, true, chunk_size);
+        check(out3.str() == expected3_lines && got3.suggestions.empty(), "top_k_stream without maps" + tag);
+    }
+
+    // Empty lines are skipped like in the batch API
+    std::stringstream pipe("helo\n\nwrold\n");
+    std::ostringstream few;
+    Result two = ac.autocorrect({"helo", "wrold"});
+    ac.autocorrect_stream(pipe, few, true, true, 1);
+    check(few.str() == two.suggestions["helo"] + "\n" + two.suggestions["wrold"], "empty lines skipped");
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": streaming\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: thread_pool_test.cpp               *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    ThreadPool pool(4);
+
+    // Back to back small batches, so workers are still draining one batch when the next is dealt
+    const int rounds = 200000;
+    bool all_ran = true, right_participant = true;
+    std::vector<std::atomic<int>> hits(8);
+    for (int round = 0; round < rounds; ++round) {
+        for (auto& h : hits) {
+            h = 0;
+        }
+        pool.parallel_for(hits.size(), [&](size_t i, int participant) {
+            ++hits[i];
+            if (participant < 0 || participant >= pool.size()) {
+                right_participant = false;
+            }
+        });
+        for (auto& h : hits) {
+            all_ran = all_ran && h.load() == 1;
+        }
+    }
+    check(all_ran, "every index run exactly once, " + std::to_string(rounds) + " back to back batches");
+    check(right_participant, "participant in [0, size())");
+
+    // Uneven sizes and grains, including fewer chunks than participants
+    bool sums = true;
+    for (int round = 0; round < 20000; ++round) {
+        size_t n = round % 37 + 1;
+        std::atomic<size_t> sum{0};
+        pool.parallel_for(n, [&](size_t i, int) { sum += i; }, round % 5 + 1);
+        sums = sums && sum.load() == n * (n - 1) / 2;
+    }
+    check(sums, "uneven batches sum up");
+
+    // An exception still lets the batch finish and comes back out, and the pool keeps working after
+    bool threw = false;
+    try {
+        pool.parallel_for(64, [&](size_t i, int) {
+            if (i == 17) {
+                throw std::runtime_error("boom");
+            }
+        });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    std::atomic<int> after{0};
+    pool.parallel_for(64, [&](size_t, int) { ++after; });
+    check(threw && after.load() == 64, "exception rethrown, pool usable after");
+
+    // Callers sharing the pool run side by side: each batch waits until every caller is inside its own. Run one at a
+    // time, the first would give up waiting instead.
+    const int callers = 3;
+    std::atomic<int> inside{0};
+    std::atomic<bool> overlapped{true};
+    std::vector<std::atomic<int>> ran(callers);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < callers; ++t) {
+        threads.emplace_back([&, t] {
+            pool.parallel_for(16, [&](size_t i, int) {
+                if (i == 0) {
+                    ++inside;
+                    auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                    while (inside.load() < callers && std::chrono::steady_clock::now() < give_up) {
+                        std::this_thread::yield();
+                    }
+                    overlapped = overlapped && inside.load() == callers;
+                }
+                ++ran[t];
+            });
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    bool every_index = true;
+    for (auto& r : ran) {
+        every_index = every_index && r.load() == 16;
+    }
+    check(overlapped && every_index, std::to_string(callers) + " callers run their batches at the same time");
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": thread pool\n";
+    return failures == 0 ? 0 : 1;
+}
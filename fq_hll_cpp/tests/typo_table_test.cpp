@@ -0,0 +1,147 @@
+/********************************************
+ * Copyright (c) 2025 Shun/翔海 (@shun4midx) *
+ * Project: FQ-HyperLogLog-Autocorrect      *
+ * File Type: C++ file                      *
+ * File: typo_table_test.cpp                *
+ ****************************************** */
+
+#include <FQ-HLL/FQ-HLL.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    };
+
+    auto seconds = [](auto fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::vector<std::string> queries;
+    std::ifstream in("test_files/typo_file.txt");
+    for (std::string line; std::getline(in, line);) {
+        queries.push_back(line);
+    }
+
+    AutocorrectorCfg cfg;
+    cfg.valid_letters = "";
+    Autocorrector plain(cfg);
+
+    // 1) Build offline over the query log, every typo in it
+    plain.build_typo_table(queries, "typo_table.bin");
+
+    cfg.typo_table = "typo_table.bin";
+    Autocorrector tabled(cfg);
+
+    Result expected, got;
+    Results expected3, got3;
+    double plain_time = seconds([&] { expected = plain.autocorrect(queries); expected3 = plain.top3(queries); });
+    double table_time = seconds([&] { got = tabled.autocorrect(queries); got3 = tabled.top3(queries); });
+
+    std::cout << std::fixed << std::setprecision(3) << "     engine " << plain_time << "s, table " << table_time << "s\n";
+    check(got.suggestions == expected.suggestions && got.scores == expected.scores, "autocorrect matches the engine");
+    check(got3.suggestions == expected3.suggestions && got3.scores == expected3.scores, "top3 matches the engine");
+    check(tabled.top_k(queries, 5).suggestions == plain.top_k(queries, 5).suggestions, "other k falls through to the engine");
+    check(tabled.autocorrect(queries, "None", false).scores == plain.autocorrect(queries, "None", false).scores, "use_keyboard = false falls through");
+
+    // 2) Another configuration ignores the table
+    AutocorrectorCfg other = cfg;
+    other.alpha = 0.3;
+    other.typo_table = "None";
+    Autocorrector mismatched(other);
+    check(!mismatched.load_typo_table("typo_table.bin"), "fingerprint mismatch rejected");
+
+    // 3) Dictionary changes turn it off
+    tabled.add_dictionary(std::vector<std::string>{"teh"});
+    check(tabled.autocorrect({"teh"}).suggestions["teh"] == "teh", "stale after add_dictionary");
+    tabled.remove_dictionary(std::vector<std::string>{"teh"});
+    plain.add_dictionary(std::vector<std::string>{"teh"});
+    plain.remove_dictionary(std::vector<std::string>{"teh"});
+    check(tabled.autocorrect(queries).suggestions == plain.autocorrect(queries).suggestions, "still matches the engine after remove_dictionary");
+    check(!tabled.load_typo_table("typo_table.bin"), "edited dictionary refuses the table again");
+
+    std::filesystem::remove("typo_table.bin");
+
+    // 4) Damaged files are rejected when loaded, before any lookup can read past the entries or probe forever
+    std::vector<std::pair<std::string, TypoEntry>> entries;
+    for (std::string typo : {"teh", "recieve", "wierd"}) {
+        entries.push_back({typo, TypoEntry{typo + "!", 1.0, {"a", "bb", "ccc"}, {0.9, 0.8, 0.7}}});
+    }
+    TypoTable::write("typo_small.bin", 42, 3, true, entries);
+
+    std::ifstream small_in("typo_small.bin", std::ios::binary);
+    std::string good((std::istreambuf_iterator<char>(small_in)), std::istreambuf_iterator<char>());
+    small_in.close();
+
+    // Header: k at 12, entries at 28, slots at 32, then 16-byte (hash, offset) slots from 48
+    auto get64 = [&](const std::string& s, size_t at) { uint64_t x; std::memcpy(&x, s.data() + at, 8); return x; };
+    auto put32 = [](std::string& s, size_t at, uint32_t x) { std::memcpy(&s[at], &x, 4); };
+    auto put64 = [](std::string& s, size_t at, uint64_t x) { std::memcpy(&s[at], &x, 8); };
+    uint64_t slots = get64(good, 32);
+    size_t used_slot = 0, empty_slot = 0;
+    for (size_t i = 0; i < slots; ++i) {
+        (get64(good, 48 + 16 * i + 8) == ~0ULL ? empty_slot : used_slot) = i;
+    }
+    size_t entries_at = 48 + 16 * slots;
+
+    auto rejected = [](const std::string& bytes) {
+        std::ofstream("typo_bad.bin", std::ios::binary) << bytes;
+        try {
+            TypoTable table("typo_bad.bin");
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+
+    TypoEntry found;
+    check(!rejected(good) && TypoTable("typo_small.bin").find("recieve", found) && found.suggestions[2] == "ccc", "intact table loads");
+    check(rejected(good.substr(0, good.size() - 1)), "truncated table rejected");
+
+    std::string bad = good;
+    put64(bad, 48 + 16 * used_slot + 8, good.size());
+    check(rejected(bad), "slot offset past the entries rejected");
+
+    bad = good;
+    put32(bad, entries_at, 0xFFFFFFFF);
+    check(rejected(bad), "string length past the entries rejected");
+
+    bad = good;
+    put32(bad, 12, 1000000000);
+    check(rejected(bad), "impossible k rejected");
+
+    bad = good;
+    for (size_t i = 0; i < slots; ++i) {
+        put64(bad, 48 + 16 * i + 8, get64(good, 48 + 16 * used_slot + 8));
+    }
+    put32(bad, 28, slots);
+    check(empty_slot != used_slot && rejected(bad), "table without an empty slot rejected");
+
+    if (std::filesystem::exists("/dev/full")) {
+        bool threw = false;
+        try {
+            TypoTable::write("/dev/full", 42, 3, true, entries);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        check(threw, "failed write throws");
+    }
+
+    std::filesystem::remove("typo_small.bin");
+    std::filesystem::remove("typo_bad.bin");
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": typo table\n";
+    return failures == 0 ? 0 : 1;
+}